@@ -0,0 +1,895 @@
+/*
+ * Offline schedulability helpers for the ipsa_sched task set.  See
+ * ipsa_analysis.h.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "ipsa_analysis.h"
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvGcd( uint64_t a,
+                        uint64_t b )
+{
+    while( b != 0U )
+    {
+        uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+
+    return a;
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullIpsaHyperperiod( const uint32_t * pulPeriods,
+                             size_t uxCount )
+{
+    uint64_t ullLcm = 1U;
+    size_t x;
+
+    for( x = 0; x < uxCount; x++ )
+    {
+        uint64_t ullStep = pulPeriods[ x ] / prvGcd( ullLcm, pulPeriods[ x ] );
+
+        if( ( ullStep != 0U ) && ( ullLcm > ( UINT64_MAX / ullStep ) ) )
+        {
+            return 0U;
+        }
+
+        ullLcm *= ullStep;
+    }
+
+    return ullLcm;
+}
+/*-----------------------------------------------------------*/
+
+double dIpsaUtilisation( const IpsaTask_t * pxTasks,
+                         const uint32_t * pulPeriods,
+                         size_t uxCount )
+{
+    double dU = 0.0;
+    size_t x;
+
+    for( x = 0; x < uxCount; x++ )
+    {
+        if( pulPeriods[ x ] != 0U )
+        {
+            dU += ( double ) pxTasks[ x ].ulWcet / ( double ) pulPeriods[ x ];
+        }
+    }
+
+    return dU;
+}
+/*-----------------------------------------------------------*/
+
+double dIpsaLiuLaylandBound( size_t uxCount )
+{
+    if( uxCount == 0U )
+    {
+        return 1.0;
+    }
+
+    return ( double ) uxCount * ( pow( 2.0, 1.0 / ( double ) uxCount ) - 1.0 );
+}
+/*-----------------------------------------------------------*/
+
+int xIpsaIsHarmonic( const uint32_t * pulPeriods,
+                     size_t uxCount )
+{
+    size_t x, y;
+
+    for( x = 0; x < uxCount; x++ )
+    {
+        for( y = 0; y < uxCount; y++ )
+        {
+            if( ( pulPeriods[ x ] <= pulPeriods[ y ] ) &&
+                ( ( pulPeriods[ x ] == 0U ) || ( ( pulPeriods[ y ] % pulPeriods[ x ] ) != 0U ) ) )
+            {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+/* State shared by the recursive harmonic chain search. */
+typedef struct HARMONIC_SEARCH
+{
+    const IpsaTask_t * pxTasks;
+    size_t uxOrder[ ipsaMAX_TASKS ];  /* Task indices sorted by nominal period. */
+    size_t uxCount;
+    uint32_t ulCurrent[ ipsaMAX_TASKS ];
+    uint32_t ulBest[ ipsaMAX_TASKS ];
+    double dBestCost;
+    int xFound;
+} HarmonicSearch_t;
+
+static double prvDeviation( const IpsaTask_t * pxTask,
+                            uint32_t ulPeriod )
+{
+    return fabs( ( double ) ulPeriod - ( double ) pxTask->ulPeriod ) / ( double ) pxTask->ulPeriod;
+}
+
+/*
+ * Extends the chain at position uxDepth with every multiple of the previous
+ * period that fits the task's range, keeping the cheapest complete chain.
+ */
+static void prvExtendChain( HarmonicSearch_t * pxSearch,
+                            size_t uxDepth,
+                            double dCost )
+{
+    const IpsaTask_t * pxTask;
+    uint32_t ulPrevious, ulMultiple;
+
+    if( dCost >= pxSearch->dBestCost )
+    {
+        return;
+    }
+
+    if( uxDepth == pxSearch->uxCount )
+    {
+        memcpy( pxSearch->ulBest, pxSearch->ulCurrent, sizeof( pxSearch->ulBest ) );
+        pxSearch->dBestCost = dCost;
+        pxSearch->xFound = 1;
+        return;
+    }
+
+    pxTask = &pxSearch->pxTasks[ pxSearch->uxOrder[ uxDepth ] ];
+    ulPrevious = pxSearch->ulCurrent[ pxSearch->uxOrder[ uxDepth - 1U ] ];
+
+    /* First multiple of the previous period that is not below the range. */
+    ulMultiple = ( ( pxTask->ulPeriodMin + ulPrevious - 1U ) / ulPrevious ) * ulPrevious;
+
+    if( ulMultiple < ulPrevious )
+    {
+        ulMultiple = ulPrevious;
+    }
+
+    for( ; ulMultiple <= pxTask->ulPeriodMax; ulMultiple += ulPrevious )
+    {
+        pxSearch->ulCurrent[ pxSearch->uxOrder[ uxDepth ] ] = ulMultiple;
+        prvExtendChain( pxSearch, uxDepth + 1U, dCost + prvDeviation( pxTask, ulMultiple ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+int xIpsaHarmonicAssign( const IpsaTask_t * pxTasks,
+                         size_t uxCount,
+                         IpsaHarmonicResult_t * pxResult )
+{
+    HarmonicSearch_t xSearch;
+    const IpsaTask_t * pxFirst;
+    uint32_t ulBase;
+    size_t x, y;
+
+    if( ( uxCount == 0U ) || ( uxCount > ipsaMAX_TASKS ) )
+    {
+        return 0;
+    }
+
+    for( x = 0; x < uxCount; x++ )
+    {
+        if( ( pxTasks[ x ].ulPeriodMin == 0U ) ||
+            ( pxTasks[ x ].ulPeriodMin > pxTasks[ x ].ulPeriodMax ) ||
+            ( pxTasks[ x ].ulPeriod == 0U ) )
+        {
+            return 0;
+        }
+    }
+
+    memset( &xSearch, 0, sizeof( xSearch ) );
+    xSearch.pxTasks = pxTasks;
+    xSearch.uxCount = uxCount;
+    xSearch.dBestCost = HUGE_VAL;
+
+    /* Insertion sort of the task indices by nominal period, the chain is
+     * built from the fastest task upwards. */
+    for( x = 0; x < uxCount; x++ )
+    {
+        for( y = x; ( y > 0U ) && ( pxTasks[ xSearch.uxOrder[ y - 1U ] ].ulPeriod > pxTasks[ x ].ulPeriod ); y-- )
+        {
+            xSearch.uxOrder[ y ] = xSearch.uxOrder[ y - 1U ];
+        }
+
+        xSearch.uxOrder[ y ] = x;
+    }
+
+    /* Every period of the fastest task's range is a candidate base. */
+    pxFirst = &pxTasks[ xSearch.uxOrder[ 0 ] ];
+
+    for( ulBase = pxFirst->ulPeriodMin; ulBase <= pxFirst->ulPeriodMax; ulBase++ )
+    {
+        xSearch.ulCurrent[ xSearch.uxOrder[ 0 ] ] = ulBase;
+        prvExtendChain( &xSearch, 1U, prvDeviation( pxFirst, ulBase ) );
+
+        if( ulBase == UINT32_MAX )
+        {
+            break;
+        }
+    }
+
+    if( xSearch.xFound == 0 )
+    {
+        return 0;
+    }
+
+    memcpy( pxResult->ulPeriods, xSearch.ulBest, sizeof( pxResult->ulPeriods ) );
+    pxResult->dCost = xSearch.dBestCost;
+    pxResult->ullHyperperiod = ullIpsaHyperperiod( pxResult->ulPeriods, uxCount );
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+/* Response times beyond this are treated as divergent. */
+#define analysisHORIZON                    ( ( uint64_t ) UINT32_MAX )
+
+static uint32_t prvThreshold( const IpsaTask_t * pxTask )
+{
+    return ( pxTask->ulThreshold > pxTask->ulPriority ) ? pxTask->ulThreshold : pxTask->ulPriority;
+}
+
+static uint32_t prvDeadline( const IpsaTask_t * pxTask )
+{
+    return ( pxTask->ulDeadline != 0U ) ? pxTask->ulDeadline : pxTask->ulPeriod;
+}
+
+static uint64_t prvCeilDiv( uint64_t a,
+                            uint64_t b )
+{
+    return ( a + b - 1U ) / b;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Non-preemptive tail of a job: the final chunk when the task declares
+ * preemption points, otherwise the whole job (which then runs at its
+ * threshold).
+ */
+static uint32_t prvTail( const IpsaTask_t * pxTask )
+{
+    uint32_t ulTail = pxTask->ulWcet;
+
+    if( pxTask->ulNonPreemptive != 0U )
+    {
+        ulTail = ( pxTask->ulLastChunk != 0U ) ? pxTask->ulLastChunk : pxTask->ulNonPreemptive;
+
+        if( ulTail > pxTask->ulWcet )
+        {
+            ulTail = pxTask->ulWcet;
+        }
+    }
+
+    return ulTail;
+}
+
+/*
+ * Blocking suffered by task uxIndex: the longest job of a lower priority
+ * task whose threshold keeps uxIndex from preempting it, or the longest
+ * non-preemptive chunk of a lower priority task.
+ */
+static uint64_t prvBlocking( const IpsaTask_t * pxTasks,
+                             size_t uxCount,
+                             size_t uxIndex )
+{
+    uint64_t ullBlocking = 0U;
+    size_t j;
+
+    for( j = 0; j < uxCount; j++ )
+    {
+        if( ( pxTasks[ j ].ulPriority < pxTasks[ uxIndex ].ulPriority ) &&
+            ( pxTasks[ j ].ulNonPreemptive == 0U ) &&
+            ( prvThreshold( &pxTasks[ j ] ) >= pxTasks[ uxIndex ].ulPriority ) &&
+            ( pxTasks[ j ].ulWcet > ullBlocking ) )
+        {
+            ullBlocking = pxTasks[ j ].ulWcet;
+        }
+
+        if( ( pxTasks[ j ].ulPriority < pxTasks[ uxIndex ].ulPriority ) &&
+            ( pxTasks[ j ].ulNonPreemptive > ullBlocking ) )
+        {
+            ullBlocking = ( pxTasks[ j ].ulNonPreemptive < pxTasks[ j ].ulWcet ) ?
+                          pxTasks[ j ].ulNonPreemptive : pxTasks[ j ].ulWcet;
+        }
+    }
+
+    return ullBlocking;
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvResponseTime( const IpsaTask_t * pxTasks,
+                                 size_t uxCount,
+                                 size_t uxIndex,
+                                 uint64_t ullExtraBlocking )
+{
+    const IpsaTask_t * pxTask = &pxTasks[ uxIndex ];
+    uint64_t ullBlocking = prvBlocking( pxTasks, uxCount, uxIndex ) + ullExtraBlocking;
+    uint64_t ullTail = prvTail( pxTask );
+    uint64_t ullBusy, ullNext, ullStart, ullFinish, ullWorst = 0U;
+    uint64_t ullJobs, ullBefore, q;
+    uint32_t ulTailThreshold;
+    size_t j;
+
+    /* A chunk that ends in no preemption point cannot be preempted at all. */
+    ulTailThreshold = ( pxTask->ulNonPreemptive != 0U ) ? UINT32_MAX : prvThreshold( pxTask );
+
+    /* Length of the level-i busy period, which bounds the number of jobs of
+     * the task that have to be examined. */
+    ullBusy = ullBlocking + pxTask->ulWcet;
+
+    for( ; ; )
+    {
+        ullNext = ullBlocking;
+
+        for( j = 0; j < uxCount; j++ )
+        {
+            if( pxTasks[ j ].ulPriority >= pxTask->ulPriority )
+            {
+                ullNext += prvCeilDiv( ullBusy, pxTasks[ j ].ulPeriod ) * pxTasks[ j ].ulWcet;
+            }
+        }
+
+        if( ullNext > analysisHORIZON )
+        {
+            return ipsaUNSCHEDULABLE;
+        }
+
+        if( ullNext == ullBusy )
+        {
+            break;
+        }
+
+        ullBusy = ullNext;
+    }
+
+    ullJobs = prvCeilDiv( ullBusy, pxTask->ulPeriod );
+
+    for( q = 0; q < ullJobs; q++ )
+    {
+        /* Latest start of the tail of job q: every higher priority job
+         * released up to and including that instant runs first. */
+        ullStart = ullBlocking + ( q * pxTask->ulWcet ) + ( pxTask->ulWcet - ullTail );
+
+        for( ; ; )
+        {
+            ullNext = ullBlocking + ( q * pxTask->ulWcet ) + ( pxTask->ulWcet - ullTail );
+
+            for( j = 0; j < uxCount; j++ )
+            {
+                if( pxTasks[ j ].ulPriority > pxTask->ulPriority )
+                {
+                    ullNext += ( 1U + ( ullStart / pxTasks[ j ].ulPeriod ) ) * pxTasks[ j ].ulWcet;
+                }
+            }
+
+            if( ullNext > analysisHORIZON )
+            {
+                return ipsaUNSCHEDULABLE;
+            }
+
+            if( ullNext == ullStart )
+            {
+                break;
+            }
+
+            ullStart = ullNext;
+        }
+
+        /* Once the tail started, only tasks above its threshold can preempt. */
+        ullFinish = ullStart + ullTail;
+
+        for( ; ; )
+        {
+            ullNext = ullStart + ullTail;
+
+            for( j = 0; j < uxCount; j++ )
+            {
+                ullBefore = 1U + ( ullStart / pxTasks[ j ].ulPeriod );
+
+                if( ( pxTasks[ j ].ulPriority > ulTailThreshold ) &&
+                    ( prvCeilDiv( ullFinish, pxTasks[ j ].ulPeriod ) > ullBefore ) )
+                {
+                    ullNext += ( prvCeilDiv( ullFinish, pxTasks[ j ].ulPeriod ) - ullBefore ) * pxTasks[ j ].ulWcet;
+                }
+            }
+
+            if( ullNext > analysisHORIZON )
+            {
+                return ipsaUNSCHEDULABLE;
+            }
+
+            if( ullNext == ullFinish )
+            {
+                break;
+            }
+
+            ullFinish = ullNext;
+        }
+
+        if( ( ullFinish - ( q * pxTask->ulPeriod ) ) > ullWorst )
+        {
+            ullWorst = ullFinish - ( q * pxTask->ulPeriod );
+        }
+    }
+
+    return ullWorst;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulIpsaResponseTime( const IpsaTask_t * pxTasks,
+                             size_t uxCount,
+                             size_t uxIndex )
+{
+    uint64_t ullWorst = prvResponseTime( pxTasks, uxCount, uxIndex, 0U );
+
+    if( ullWorst > prvDeadline( &pxTasks[ uxIndex ] ) )
+    {
+        return ipsaUNSCHEDULABLE;
+    }
+
+    return ( uint32_t ) ullWorst;
+}
+/*-----------------------------------------------------------*/
+
+int xIpsaIsSchedulable( const IpsaTask_t * pxTasks,
+                        size_t uxCount )
+{
+    size_t x;
+
+    for( x = 0; x < uxCount; x++ )
+    {
+        if( ulIpsaResponseTime( pxTasks, uxCount, x ) == ipsaUNSCHEDULABLE )
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+int xIpsaAssignThresholds( IpsaTask_t * pxTasks,
+                           size_t uxCount )
+{
+    uint32_t ulTop = 0U;
+    size_t uxVisited, x, uxNext;
+    int xDone[ ipsaMAX_TASKS ] = { 0 };
+
+    if( ( uxCount > ipsaMAX_TASKS ) || ( xIpsaIsSchedulable( pxTasks, uxCount ) == 0 ) )
+    {
+        return 0;
+    }
+
+    for( x = 0; x < uxCount; x++ )
+    {
+        if( pxTasks[ x ].ulPriority > ulTop )
+        {
+            ulTop = pxTasks[ x ].ulPriority;
+        }
+
+        pxTasks[ x ].ulThreshold = pxTasks[ x ].ulPriority;
+    }
+
+    for( uxVisited = 0; uxVisited < uxCount; uxVisited++ )
+    {
+        /* Highest priority task not visited yet. */
+        uxNext = uxCount;
+
+        for( x = 0; x < uxCount; x++ )
+        {
+            if( ( xDone[ x ] == 0 ) &&
+                ( ( uxNext == uxCount ) || ( pxTasks[ x ].ulPriority > pxTasks[ uxNext ].ulPriority ) ) )
+            {
+                uxNext = x;
+            }
+        }
+
+        xDone[ uxNext ] = 1;
+
+        /* Raising the threshold only adds blocking to the tasks it now
+         * shields from, so stop at the first level that breaks the set. */
+        while( pxTasks[ uxNext ].ulThreshold < ulTop )
+        {
+            pxTasks[ uxNext ].ulThreshold++;
+
+            if( xIpsaIsSchedulable( pxTasks, uxCount ) == 0 )
+            {
+                pxTasks[ uxNext ].ulThreshold--;
+                break;
+            }
+        }
+    }
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+/* Returns 1 if task a can preempt a running job of task b. */
+static int prvCanPreempt( const IpsaTask_t * pxA,
+                          const IpsaTask_t * pxB )
+{
+    return pxA->ulPriority > prvThreshold( pxB );
+}
+
+size_t uxIpsaStackGroups( const IpsaTask_t * pxTasks,
+                          size_t uxCount,
+                          uint32_t * pulGroup )
+{
+    size_t uxGroups = 0U;
+    size_t x, y;
+    uint32_t ulGroup;
+    int xFits;
+
+    /* Greedy first fit: a task joins the first group none of whose members
+     * it can preempt or be preempted by. */
+    for( x = 0; x < uxCount; x++ )
+    {
+        for( ulGroup = 0U; ulGroup < uxGroups; ulGroup++ )
+        {
+            xFits = 1;
+
+            for( y = 0; y < x; y++ )
+            {
+                if( ( pulGroup[ y ] == ulGroup ) &&
+                    ( prvCanPreempt( &pxTasks[ x ], &pxTasks[ y ] ) || prvCanPreempt( &pxTasks[ y ], &pxTasks[ x ] ) ) )
+                {
+                    xFits = 0;
+                    break;
+                }
+            }
+
+            if( xFits != 0 )
+            {
+                break;
+            }
+        }
+
+        pulGroup[ x ] = ulGroup;
+
+        if( ulGroup == uxGroups )
+        {
+            uxGroups++;
+        }
+    }
+
+    return uxGroups;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulIpsaStackRequirement( const IpsaTask_t * pxTasks,
+                                 size_t uxCount )
+{
+    uint32_t ulChain[ ipsaMAX_TASKS ];
+    uint32_t ulWorst = 0U, ulBest;
+    size_t uxDone, x, y, uxNext;
+    int xDone[ ipsaMAX_TASKS ] = { 0 };
+
+    if( uxCount > ipsaMAX_TASKS )
+    {
+        return 0U;
+    }
+
+    /* Longest path through the "can preempt" graph, which is acyclic and
+     * ordered by priority, so tasks are visited from the lowest priority. */
+    for( uxDone = 0; uxDone < uxCount; uxDone++ )
+    {
+        uxNext = uxCount;
+
+        for( x = 0; x < uxCount; x++ )
+        {
+            if( ( xDone[ x ] == 0 ) &&
+                ( ( uxNext == uxCount ) || ( pxTasks[ x ].ulPriority < pxTasks[ uxNext ].ulPriority ) ) )
+            {
+                uxNext = x;
+            }
+        }
+
+        xDone[ uxNext ] = 1;
+        ulBest = 0U;
+
+        for( y = 0; y < uxCount; y++ )
+        {
+            if( ( y != uxNext ) && ( xDone[ y ] != 0 ) &&
+                prvCanPreempt( &pxTasks[ uxNext ], &pxTasks[ y ] ) && ( ulChain[ y ] > ulBest ) )
+            {
+                ulBest = ulChain[ y ];
+            }
+        }
+
+        ulChain[ uxNext ] = ulBest + pxTasks[ uxNext ].ulStackWords;
+
+        if( ulChain[ uxNext ] > ulWorst )
+        {
+            ulWorst = ulChain[ uxNext ];
+        }
+    }
+
+    return ulWorst;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Returns 1 if every task of higher priority than uxIndex meets its deadline
+ * when uxIndex runs in non-preemptive chunks of ulChunk, 0 meaning fully
+ * preemptive.  pxTasks is modified.
+ */
+static int prvChunkFits( IpsaTask_t * pxTasks,
+                         size_t uxCount,
+                         size_t uxIndex,
+                         uint32_t ulChunk )
+{
+    size_t k;
+
+    pxTasks[ uxIndex ].ulNonPreemptive = ulChunk;
+    pxTasks[ uxIndex ].ulThreshold = 0U;
+
+    for( k = 0; k < uxCount; k++ )
+    {
+        if( ( pxTasks[ k ].ulPriority > pxTasks[ uxIndex ].ulPriority ) &&
+            ( prvResponseTime( pxTasks, uxCount, k, 0U ) > prvDeadline( &pxTasks[ k ] ) ) )
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulIpsaNonPreemptiveBudget( const IpsaTask_t * pxTasks,
+                                   size_t uxCount,
+                                   size_t uxIndex )
+{
+    IpsaTask_t xTasks[ ipsaMAX_TASKS ];
+    uint32_t ulLow, ulHigh, ulMid;
+    size_t k;
+    int xHigher = 0;
+
+    if( uxCount > ipsaMAX_TASKS )
+    {
+        return 0U;
+    }
+
+    for( k = 0; k < uxCount; k++ )
+    {
+        xTasks[ k ] = pxTasks[ k ];
+        xHigher |= ( pxTasks[ k ].ulPriority > pxTasks[ uxIndex ].ulPriority );
+    }
+
+    /* The chunk replaces, rather than adds to, whatever uxIndex declared:
+     * the other tasks' chunks keep blocking as they are. */
+    if( ( xHigher == 0 ) || ( prvChunkFits( xTasks, uxCount, uxIndex, pxTasks[ uxIndex ].ulWcet ) != 0 ) )
+    {
+        /* A chunk never blocks for longer than the whole job. */
+        return UINT32_MAX;
+    }
+
+    if( prvChunkFits( xTasks, uxCount, uxIndex, 0U ) == 0 )
+    {
+        return 0U;
+    }
+
+    /* Largest chunk that fits, by bisection: blocking only grows with it. */
+    ulLow = 0U;
+    ulHigh = pxTasks[ uxIndex ].ulWcet;
+
+    while( ulLow < ulHigh )
+    {
+        ulMid = ulLow + ( ( ulHigh - ulLow + 1U ) / 2U );
+
+        if( prvChunkFits( xTasks, uxCount, uxIndex, ulMid ) != 0 )
+        {
+            ulLow = ulMid;
+        }
+        else
+        {
+            ulHigh = ulMid - 1U;
+        }
+    }
+
+    return ulLow;
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullIpsaSupplyBound( uint32_t ulPeriod,
+                             uint32_t ulBudget,
+                             uint64_t ullTime )
+{
+    uint64_t ullGap = ( uint64_t ) ulPeriod - ulBudget;
+    uint64_t ullPeriods, ullPartial;
+
+    /* In the worst case the budget is served at the start of one period and
+     * at the end of the next, leaving a starvation gap of 2 ( P - Q ). */
+    if( ullTime <= ullGap )
+    {
+        return 0U;
+    }
+
+    ullPeriods = ( ullTime - ullGap ) / ulPeriod;
+    ullPartial = 0U;
+
+    if( ullTime > ( 2U * ullGap ) + ( ullPeriods * ulPeriod ) )
+    {
+        ullPartial = ullTime - ( 2U * ullGap ) - ( ullPeriods * ulPeriod );
+    }
+
+    return ( ullPeriods * ulBudget ) + ullPartial;
+}
+/*-----------------------------------------------------------*/
+
+static int prvGroupFpSchedulable( const IpsaTask_t * pxTasks,
+                                  size_t uxCount,
+                                  uint32_t ulPeriod,
+                                  uint32_t ulBudget )
+{
+    uint64_t ullDemand, ullPoint;
+    size_t i, j, k;
+    int xFits;
+
+    for( i = 0; i < uxCount; i++ )
+    {
+        xFits = 0;
+
+        /* The request bound only steps at releases of higher priority jobs,
+         * so it is enough to test those instants and the deadline. */
+        for( k = 0; ( k <= uxCount ) && ( xFits == 0 ); k++ )
+        {
+            uint64_t ullStep = ( k < uxCount ) ? pxTasks[ k ].ulPeriod : prvDeadline( &pxTasks[ i ] );
+
+            if( ( k < uxCount ) && ( pxTasks[ k ].ulPriority <= pxTasks[ i ].ulPriority ) )
+            {
+                continue;
+            }
+
+            for( ullPoint = ullStep; ( ullPoint <= prvDeadline( &pxTasks[ i ] ) ) && ( xFits == 0 ); ullPoint += ullStep )
+            {
+                ullDemand = pxTasks[ i ].ulWcet;
+
+                for( j = 0; j < uxCount; j++ )
+                {
+                    if( pxTasks[ j ].ulPriority > pxTasks[ i ].ulPriority )
+                    {
+                        ullDemand += prvCeilDiv( ullPoint, pxTasks[ j ].ulPeriod ) * pxTasks[ j ].ulWcet;
+                    }
+                }
+
+                xFits = ( ullDemand <= ullIpsaSupplyBound( ulPeriod, ulBudget, ullPoint ) );
+            }
+        }
+
+        if( xFits == 0 )
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+static int prvGroupEdfSchedulable( const IpsaTask_t * pxTasks,
+                                   size_t uxCount,
+                                   uint32_t ulPeriod,
+                                   uint32_t ulBudget )
+{
+    uint32_t ulPeriods[ ipsaMAX_TASKS ];
+    uint64_t ullHorizon, ullPoint, ullDemand;
+    uint32_t ulMaxDeadline = 0U;
+    size_t j, k;
+
+    if( uxCount == 0U )
+    {
+        return 1;
+    }
+
+    if( ( ulBudget == 0U ) || ( uxCount > ipsaMAX_TASKS ) )
+    {
+        return 0;
+    }
+
+    for( j = 0; j < uxCount; j++ )
+    {
+        ulPeriods[ j ] = pxTasks[ j ].ulPeriod;
+
+        if( prvDeadline( &pxTasks[ j ] ) > ulMaxDeadline )
+        {
+            ulMaxDeadline = prvDeadline( &pxTasks[ j ] );
+        }
+    }
+
+    if( dIpsaUtilisation( pxTasks, ulPeriods, uxCount ) > ( ( double ) ulBudget / ( double ) ulPeriod ) )
+    {
+        return 0;
+    }
+
+    /* Demand is checked over one hyperperiod past the largest deadline, the
+     * pattern repeats afterwards. */
+    ullHorizon = ullIpsaHyperperiod( ulPeriods, uxCount );
+
+    if( ( ullHorizon == 0U ) || ( ullHorizon > analysisHORIZON ) )
+    {
+        ullHorizon = analysisHORIZON;
+    }
+
+    ullHorizon += ulMaxDeadline;
+
+    for( k = 0; k < uxCount; k++ )
+    {
+        for( ullPoint = prvDeadline( &pxTasks[ k ] ); ullPoint <= ullHorizon; ullPoint += pxTasks[ k ].ulPeriod )
+        {
+            ullDemand = 0U;
+
+            for( j = 0; j < uxCount; j++ )
+            {
+                if( ullPoint >= prvDeadline( &pxTasks[ j ] ) )
+                {
+                    ullDemand += ( ( ( ullPoint - prvDeadline( &pxTasks[ j ] ) ) / pxTasks[ j ].ulPeriod ) + 1U ) * pxTasks[ j ].ulWcet;
+                }
+            }
+
+            if( ullDemand > ullIpsaSupplyBound( ulPeriod, ulBudget, ullPoint ) )
+            {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+int xIpsaGroupIsSchedulable( const IpsaTask_t * pxTasks,
+                             size_t uxCount,
+                             int xPolicy,
+                             uint32_t ulPeriod,
+                             uint32_t ulBudget )
+{
+    if( ( ulPeriod == 0U ) || ( ulBudget > ulPeriod ) )
+    {
+        return 0;
+    }
+
+    if( xPolicy == ipsaLOCAL_EDF )
+    {
+        return prvGroupEdfSchedulable( pxTasks, uxCount, ulPeriod, ulBudget );
+    }
+
+    return prvGroupFpSchedulable( pxTasks, uxCount, ulPeriod, ulBudget );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulIpsaGroupMinBudget( const IpsaTask_t * pxTasks,
+                               size_t uxCount,
+                               int xPolicy,
+                               uint32_t ulPeriod )
+{
+    uint32_t ulLow = 0U, ulHigh = ulPeriod, ulMid;
+
+    if( xIpsaGroupIsSchedulable( pxTasks, uxCount, xPolicy, ulPeriod, ulPeriod ) == 0 )
+    {
+        return ipsaUNSCHEDULABLE;
+    }
+
+    /* Schedulability is monotonic in the budget. */
+    while( ulLow < ulHigh )
+    {
+        ulMid = ulLow + ( ( ulHigh - ulLow ) / 2U );
+
+        if( xIpsaGroupIsSchedulable( pxTasks, uxCount, xPolicy, ulPeriod, ulMid ) != 0 )
+        {
+            ulHigh = ulMid;
+        }
+        else
+        {
+            ulLow = ulMid + 1U;
+        }
+    }
+
+    return ulLow;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,164 @@
+/*
+ * Offline schedulability helpers for the ipsa_sched task set.
+ *
+ * Everything in this module is plain C with no dependency on the FreeRTOS
+ * kernel, so it can be linked into the demo as well as into the host side
+ * tools.  All times are expressed in milliseconds.
+ */
+
+#ifndef IPSA_ANALYSIS_H
+#define IPSA_ANALYSIS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Upper bound on the number of tasks handled by the analysis routines. */
+#define ipsaMAX_TASKS                      ( 16 )
+
+/* Description of one periodic task as seen by the analysis. */
+typedef struct IPSA_TASK
+{
+    const char * pcName;
+    uint32_t ulPeriodMin;     /* Smallest acceptable period. */
+    uint32_t ulPeriod;        /* Nominal (currently configured) period. */
+    uint32_t ulPeriodMax;     /* Largest acceptable period. */
+    uint32_t ulWcet;          /* Worst case execution time, 0 if unknown. */
+    uint32_t ulPriority;      /* Fixed priority, higher value is more urgent. */
+    uint32_t ulThreshold;     /* Preemption threshold, 0 means ulPriority. */
+    uint32_t ulDeadline;      /* Relative deadline, 0 means ulPeriod. */
+    uint32_t ulStackWords;    /* Stack size, only used for stack sharing. */
+    uint32_t ulNonPreemptive; /* Longest chunk between preemption points, 0 if fully preemptive. */
+    uint32_t ulLastChunk;     /* Length of the final chunk, 0 means ulNonPreemptive. */
+} IpsaTask_t;
+
+/* Local scheduling policy of a task group. */
+#define ipsaLOCAL_FP                       ( 0 )
+#define ipsaLOCAL_EDF                      ( 1 )
+
+/* Returned by ulIpsaResponseTime() when a task misses its deadline. */
+#define ipsaUNSCHEDULABLE                  ( UINT32_MAX )
+
+/* Result of a harmonic period assignment. */
+typedef struct IPSA_HARMONIC_RESULT
+{
+    uint32_t ulPeriods[ ipsaMAX_TASKS ]; /* Chosen period, indexed like the input. */
+    double dCost;                        /* Sum of relative deviations from nominal. */
+    uint64_t ullHyperperiod;             /* Hyperperiod of the chosen set. */
+} IpsaHarmonicResult_t;
+
+/*
+ * Least common multiple of the given periods.  Returns 0 on overflow.
+ */
+uint64_t ullIpsaHyperperiod( const uint32_t * pulPeriods,
+                             size_t uxCount );
+
+/*
+ * Total utilisation sum( C / T ) of the given periods.
+ */
+double dIpsaUtilisation( const IpsaTask_t * pxTasks,
+                         const uint32_t * pulPeriods,
+                         size_t uxCount );
+
+/*
+ * Liu & Layland rate monotonic bound n( 2^(1/n) - 1 ).  A harmonic task set
+ * is schedulable up to 1.0 instead.
+ */
+double dIpsaLiuLaylandBound( size_t uxCount );
+
+/*
+ * Returns 1 if every period divides every larger one.
+ */
+int xIpsaIsHarmonic( const uint32_t * pulPeriods,
+                     size_t uxCount );
+
+/*
+ * Search for the harmonic period set closest to the nominal periods while
+ * keeping each period inside [ ulPeriodMin, ulPeriodMax ].  Returns 1 and
+ * fills pxResult on success, 0 if no harmonic set fits the ranges.
+ */
+int xIpsaHarmonicAssign( const IpsaTask_t * pxTasks,
+                         size_t uxCount,
+                         IpsaHarmonicResult_t * pxResult );
+
+/*
+ * Worst case response time of task uxIndex under fixed priority scheduling
+ * with preemption thresholds and non-preemptive chunks (fully preemptive
+ * when every threshold equals the priority and no chunk is declared).
+ * Returns ipsaUNSCHEDULABLE if the response time exceeds the deadline.
+ */
+uint32_t ulIpsaResponseTime( const IpsaTask_t * pxTasks,
+                             size_t uxCount,
+                             size_t uxIndex );
+
+/*
+ * Returns 1 if every task meets its deadline according to
+ * ulIpsaResponseTime().
+ */
+int xIpsaIsSchedulable( const IpsaTask_t * pxTasks,
+                        size_t uxCount );
+
+/*
+ * Raises each task's ulThreshold as far as possible while the set stays
+ * schedulable, visiting tasks from the highest priority down.  Returns 0
+ * (thresholds untouched) if the set is not schedulable to begin with.
+ */
+int xIpsaAssignThresholds( IpsaTask_t * pxTasks,
+                           size_t uxCount );
+
+/*
+ * Partitions the tasks into groups whose members can never preempt each
+ * other and could therefore run on one shared stack.  pulGroup[ x ] receives
+ * the group of task x.  Returns the number of groups.
+ */
+size_t uxIpsaStackGroups( const IpsaTask_t * pxTasks,
+                          size_t uxCount,
+                          uint32_t * pulGroup );
+
+/*
+ * Worst case total stack, in words, needed when tasks sharing a group share
+ * their stack: the heaviest chain of tasks that can preempt one another.
+ */
+uint32_t ulIpsaStackRequirement( const IpsaTask_t * pxTasks,
+                                 size_t uxCount );
+
+/*
+ * Longest non-preemptive chunk task uxIndex may declare without making any
+ * higher priority task miss its deadline, the chunks the other tasks declare
+ * included.  Returns UINT32_MAX if any chunk fits, for the highest priority
+ * task for instance, and 0 if a higher priority task misses its deadline
+ * even with uxIndex fully preemptive.
+ */
+uint32_t ulIpsaNonPreemptiveBudget( const IpsaTask_t * pxTasks,
+                                   size_t uxCount,
+                                   size_t uxIndex );
+
+/*
+ * Minimum supply a periodic resource delivering ulBudget every ulPeriod
+ * guarantees in any window of length ulTime (Shin & Lee).
+ */
+uint64_t ullIpsaSupplyBound( uint32_t ulPeriod,
+                             uint32_t ulBudget,
+                             uint64_t ullTime );
+
+/*
+ * Returns 1 if the tasks of one group meet their deadlines under the local
+ * policy (ipsaLOCAL_FP or ipsaLOCAL_EDF) when the group is given ulBudget
+ * every ulPeriod.  Only the group's own tasks are examined, so a group can
+ * be validated in isolation and admitted at the top level by bandwidth alone.
+ */
+int xIpsaGroupIsSchedulable( const IpsaTask_t * pxTasks,
+                             size_t uxCount,
+                             int xPolicy,
+                             uint32_t ulPeriod,
+                             uint32_t ulBudget );
+
+/*
+ * Smallest budget per ulPeriod that keeps the group schedulable, or
+ * ipsaUNSCHEDULABLE if even the full period is not enough.
+ */
+uint32_t ulIpsaGroupMinBudget( const IpsaTask_t * pxTasks,
+                               size_t uxCount,
+                               int xPolicy,
+                               uint32_t ulPeriod );
+
+#endif /* IPSA_ANALYSIS_H */
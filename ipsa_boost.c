@@ -0,0 +1,89 @@
+/*
+ * Occupancy driven priority boosting, see ipsa_boost.h.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "ipsa_boost.h"
+
+/*-----------------------------------------------------------*/
+
+void vIpsaBoostInit( IpsaBoost_t * pxBoost,
+                     TaskHandle_t xConsumer,
+                     UBaseType_t uxBoostPriority,
+                     UBaseType_t uxHigh,
+                     UBaseType_t uxLow )
+{
+    configASSERT( uxLow < uxHigh );
+
+    pxBoost->xConsumer = xConsumer;
+    pxBoost->uxBasePriority = uxTaskPriorityGet( xConsumer );
+    pxBoost->uxBoostPriority = uxBoostPriority;
+    pxBoost->uxHigh = uxHigh;
+    pxBoost->uxLow = uxLow;
+    pxBoost->xBoosted = pdFALSE;
+    pxBoost->xRaised = pdFALSE;
+    pxBoost->xBoostStart = 0;
+    pxBoost->ulBoosts = 0;
+    pxBoost->ulBoostedTicks = 0;
+    pxBoost->uxPeak = 0;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaBoostUpdate( IpsaBoost_t * pxBoost,
+                             UBaseType_t uxOccupancy )
+{
+    BaseType_t xBoosted, xEnd = pdFALSE;
+    UBaseType_t uxCurrent;
+
+    /* Producer and consumer both report, decide the transition atomically. */
+    taskENTER_CRITICAL();
+    {
+        if( uxOccupancy > pxBoost->uxPeak )
+        {
+            pxBoost->uxPeak = uxOccupancy;
+        }
+
+        if( ( pxBoost->xBoosted == pdFALSE ) && ( uxOccupancy >= pxBoost->uxHigh ) )
+        {
+            pxBoost->xBoosted = pdTRUE;
+            pxBoost->xBoostStart = xTaskGetTickCount();
+            pxBoost->ulBoosts++;
+        }
+        else if( ( pxBoost->xBoosted != pdFALSE ) && ( uxOccupancy <= pxBoost->uxLow ) )
+        {
+            pxBoost->xBoosted = pdFALSE;
+            pxBoost->ulBoostedTicks += ( uint32_t ) ( xTaskGetTickCount() - pxBoost->xBoostStart );
+            xEnd = pdTRUE;
+        }
+
+        xBoosted = pxBoost->xBoosted;
+    }
+    taskEXIT_CRITICAL();
+
+    /* Checked on every report while boosted, as another priority change may
+     * have dropped the consumer below the boost. */
+    uxCurrent = uxTaskPriorityGet( pxBoost->xConsumer );
+
+    if( ( xBoosted != pdFALSE ) && ( uxCurrent < pxBoost->uxBoostPriority ) )
+    {
+        pxBoost->xRaised = pdTRUE;
+        vTaskPrioritySet( pxBoost->xConsumer, pxBoost->uxBoostPriority );
+    }
+    else if( xEnd != pdFALSE )
+    {
+        /* Only a raise of its own, still in place, is undone. */
+        if( ( pxBoost->xRaised != pdFALSE ) && ( uxCurrent == pxBoost->uxBoostPriority ) )
+        {
+            vTaskPrioritySet( pxBoost->xConsumer, pxBoost->uxBasePriority );
+        }
+
+        pxBoost->xRaised = pdFALSE;
+    }
+
+    return xEnd;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,57 @@
+/*
+ * Consumer priority boosting driven by queue occupancy.
+ *
+ * A consumer that falls behind lets its queue fill until producers sending
+ * with a zero timeout start dropping.  Producer and consumer report the
+ * occupancy after each send and receive with vIpsaBoostUpdate(): once it
+ * reaches uxHigh the consumer runs at uxBoostPriority, once it falls to uxLow
+ * it returns to its base priority.  The gap between the watermarks keeps a
+ * queue hovering near one level from toggling the priority on every
+ * message.
+ *
+ * A boost never lowers the consumer.  Ending one only undoes a raise the
+ * boost made itself, so a priority that something else set, such as
+ * deadline inheritance, is left alone even when it equals uxBoostPriority.
+ * vIpsaBoostUpdate() changes priorities, so call it from tasks only (timer
+ * callbacks included), not from interrupts.
+ */
+
+#ifndef IPSA_BOOST_H
+#define IPSA_BOOST_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+typedef struct IPSA_BOOST
+{
+    TaskHandle_t xConsumer;
+    UBaseType_t uxBasePriority;
+    UBaseType_t uxBoostPriority;
+    UBaseType_t uxHigh;             /* Occupancy that starts a boost. */
+    UBaseType_t uxLow;              /* Occupancy that ends it. */
+    volatile BaseType_t xBoosted;
+    BaseType_t xRaised;             /* pdTRUE once the boost set the priority itself. */
+    TickType_t xBoostStart;
+    uint32_t ulBoosts;              /* Boosts started. */
+    uint32_t ulBoostedTicks;        /* Time spent boosted, boosts that ended. */
+    UBaseType_t uxPeak;             /* Highest occupancy reported. */
+} IpsaBoost_t;
+
+/*
+ * Watches the queue of xConsumer, whose current priority is its base
+ * priority.  uxLow must be below uxHigh.
+ */
+void vIpsaBoostInit( IpsaBoost_t * pxBoost,
+                     TaskHandle_t xConsumer,
+                     UBaseType_t uxBoostPriority,
+                     UBaseType_t uxHigh,
+                     UBaseType_t uxLow );
+
+/*
+ * Reports uxOccupancy messages in the consumer's queue, after a send or a
+ * receive.  Returns pdTRUE if this call ended a boost.
+ */
+BaseType_t xIpsaBoostUpdate( IpsaBoost_t * pxBoost,
+                             UBaseType_t uxOccupancy );
+
+#endif /* IPSA_BOOST_H */
@@ -0,0 +1,328 @@
+/*
+ * Constant Bandwidth Server reservations, see ipsa_cbs.h.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+/* Local includes. */
+#include "ipsa_cbs.h"
+
+/*-----------------------------------------------------------*/
+
+/* Registered servers. */
+static IpsaCbsServer_t * pxServers[ ipsaCBS_MAX_SERVERS ];
+static UBaseType_t uxServerCount = 0;
+
+/* Bandwidth already admitted, in per mille. */
+static uint32_t ulAdmittedBandwidth = 0;
+
+/* Set while a re-rank is pending in the timer daemon, so the tick hook does
+ * not flood the timer command queue. */
+static volatile BaseType_t xRerankPending = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Gives ipsaCBS_RUN_PRIORITY to the active, non throttled server with the
+ * earliest deadline and ipsaCBS_WAIT_PRIORITY to all others.  Runs in the
+ * timer daemon task or in the served task itself.
+ */
+static void prvRerank( void * pvParameter1,
+                       uint32_t ulParameter2 );
+
+/*
+ * Registers the release of a job at tick xNow and returns pdTRUE if the
+ * servers must be re-ranked.  Must be called with interrupts masked or from
+ * the tick hook.
+ */
+static BaseType_t prvArrival( IpsaCbsServer_t * pxServer,
+                              TickType_t xNow );
+
+/* Returns pdTRUE if tick a is before tick b, taking wrap around into account. */
+static BaseType_t prvBefore( TickType_t a,
+                             TickType_t b );
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvBefore( TickType_t a,
+                             TickType_t b )
+{
+    return ( ( TickType_t ) ( a - b ) > ( portMAX_DELAY / 2U ) ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaCbsCreate( IpsaCbsServer_t * pxServer,
+                           TaskHandle_t xTask,
+                           TickType_t xBudget,
+                           TickType_t xPeriod,
+                           BaseType_t xHard )
+{
+    uint32_t ulBandwidth;
+    BaseType_t xReturn = pdFAIL;
+
+    configASSERT( ( xBudget > 0 ) && ( xBudget <= xPeriod ) );
+
+    ulBandwidth = ( uint32_t ) ( ( ( uint64_t ) xBudget * 1000U + xPeriod - 1U ) / xPeriod );
+
+    taskENTER_CRITICAL();
+    {
+        if( ( uxServerCount < ipsaCBS_MAX_SERVERS ) &&
+            ( ( ulAdmittedBandwidth + ulBandwidth ) <= ipsaCBS_MAX_BANDWIDTH ) )
+        {
+            pxServer->xTask = xTask;
+            pxServer->xBudget = xBudget;
+            pxServer->xPeriod = xPeriod;
+            pxServer->xRemaining = 0;
+            pxServer->xDeadline = xTaskGetTickCount();
+            pxServer->xThrottledUntil = 0;
+            pxServer->xDebt = 0;
+            pxServer->xNextRelease = 0;
+            pxServer->xHard = xHard;
+            pxServer->xPeriodic = pdFALSE;
+            pxServer->uxPending = 0;
+            pxServer->xThrottled = pdFALSE;
+            pxServer->ulJobs = 0;
+            pxServer->ulPostponements = 0;
+
+            pxServers[ uxServerCount++ ] = pxServer;
+            ulAdmittedBandwidth += ulBandwidth;
+            xReturn = pdPASS;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( xReturn == pdPASS )
+    {
+        vTaskPrioritySet( xTask, ipsaCBS_WAIT_PRIORITY );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaCbsPeriodicReleases( IpsaCbsServer_t * pxServer,
+                               TickType_t xFirstRelease )
+{
+    taskENTER_CRITICAL();
+    {
+        pxServer->xNextRelease = xFirstRelease;
+        pxServer->xPeriodic = pdTRUE;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvArrival( IpsaCbsServer_t * pxServer,
+                              TickType_t xNow )
+{
+    pxServer->ulJobs++;
+
+    /* A job released while the previous one still runs is served after it,
+     * with the budget and deadline already in place. */
+    if( pxServer->uxPending++ != 0U )
+    {
+        return pdFALSE;
+    }
+
+    /* CBS arrival rule: the remaining budget can only be used up to the
+     * current deadline if doing so does not exceed Q / P, that is when
+     * c < ( d - t ) * Q / P.  Otherwise a new server period starts.  A
+     * throttled server keeps waiting for its replenishment. */
+    if( ( pxServer->xThrottled == pdFALSE ) &&
+        ( ( prvBefore( pxServer->xDeadline, xNow ) != pdFALSE ) ||
+          ( ( ( uint64_t ) pxServer->xRemaining * pxServer->xPeriod ) >=
+            ( ( uint64_t ) ( pxServer->xDeadline - xNow ) * pxServer->xBudget ) ) ) )
+    {
+        pxServer->xDeadline = xNow + pxServer->xPeriod;
+        pxServer->xRemaining = pxServer->xBudget;
+    }
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaCbsJobArrival( IpsaCbsServer_t * pxServer )
+{
+    BaseType_t xRerank;
+
+    taskENTER_CRITICAL();
+    {
+        xRerank = prvArrival( pxServer, xTaskGetTickCount() );
+    }
+    taskEXIT_CRITICAL();
+
+    if( xRerank != pdFALSE )
+    {
+        prvRerank( NULL, 0 );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaCbsJobComplete( IpsaCbsServer_t * pxServer )
+{
+    BaseType_t xRerank = pdFALSE;
+
+    taskENTER_CRITICAL();
+    {
+        if( pxServer->uxPending > 0U )
+        {
+            pxServer->uxPending--;
+            xRerank = ( pxServer->uxPending == 0U ) ? pdTRUE : pdFALSE;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( xRerank != pdFALSE )
+    {
+        prvRerank( NULL, 0 );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvRerank( void * pvParameter1,
+                       uint32_t ulParameter2 )
+{
+    UBaseType_t uxPriorities[ ipsaCBS_MAX_SERVERS ];
+    TaskHandle_t xTasks[ ipsaCBS_MAX_SERVERS ];
+    UBaseType_t uxCount, x, uxEarliest;
+
+    ( void ) pvParameter1;
+    ( void ) ulParameter2;
+
+    taskENTER_CRITICAL();
+    {
+        xRerankPending = pdFALSE;
+        uxCount = uxServerCount;
+        uxEarliest = uxCount;
+
+        for( x = 0; x < uxCount; x++ )
+        {
+            if( ( pxServers[ x ]->uxPending > 0U ) &&
+                ( pxServers[ x ]->xThrottled == pdFALSE ) &&
+                ( ( uxEarliest == uxCount ) ||
+                  ( prvBefore( pxServers[ x ]->xDeadline, pxServers[ uxEarliest ]->xDeadline ) != pdFALSE ) ) )
+            {
+                uxEarliest = x;
+            }
+        }
+
+        for( x = 0; x < uxCount; x++ )
+        {
+            xTasks[ x ] = pxServers[ x ]->xTask;
+            uxPriorities[ x ] = ( x == uxEarliest ) ? ipsaCBS_RUN_PRIORITY : ipsaCBS_WAIT_PRIORITY;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    /* Demote first so two servers never share the run priority. */
+    for( x = 0; x < uxCount; x++ )
+    {
+        if( ( uxPriorities[ x ] == ipsaCBS_WAIT_PRIORITY ) && ( uxTaskPriorityGet( xTasks[ x ] ) != ipsaCBS_WAIT_PRIORITY ) )
+        {
+            vTaskPrioritySet( xTasks[ x ], ipsaCBS_WAIT_PRIORITY );
+        }
+    }
+
+    if( ( uxEarliest < uxCount ) && ( uxTaskPriorityGet( xTasks[ uxEarliest ] ) != ipsaCBS_RUN_PRIORITY ) )
+    {
+        vTaskPrioritySet( xTasks[ uxEarliest ], ipsaCBS_RUN_PRIORITY );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaCbsTickHook( void )
+{
+    TaskHandle_t xCurrent = xTaskGetCurrentTaskHandle();
+    TickType_t xNow = xTaskGetTickCountFromISR();
+    BaseType_t xRerank = pdFALSE;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    IpsaCbsServer_t * pxServer;
+    UBaseType_t x;
+
+    for( x = 0; x < uxServerCount; x++ )
+    {
+        pxServer = pxServers[ x ];
+
+        /* A throttled server gets its budget back at its old deadline, less
+         * what a hard server ran meanwhile. */
+        if( ( pxServer->xThrottled != pdFALSE ) &&
+            ( prvBefore( xNow, pxServer->xThrottledUntil ) == pdFALSE ) )
+        {
+            pxServer->xDeadline += pxServer->xPeriod;
+
+            /* Preempted past its deadline before running out, start over. */
+            if( prvBefore( pxServer->xDeadline, xNow ) != pdFALSE )
+            {
+                pxServer->xDeadline = xNow + pxServer->xPeriod;
+            }
+
+            if( pxServer->xDebt >= pxServer->xBudget )
+            {
+                pxServer->xDebt -= pxServer->xBudget;
+                pxServer->xThrottledUntil += pxServer->xPeriod;
+            }
+            else
+            {
+                pxServer->xRemaining = pxServer->xBudget - pxServer->xDebt;
+                pxServer->xDebt = 0;
+                pxServer->xThrottled = pdFALSE;
+                xRerank = pdTRUE;
+            }
+        }
+
+        if( ( pxServer->xPeriodic != pdFALSE ) &&
+            ( prvBefore( xNow, pxServer->xNextRelease ) == pdFALSE ) )
+        {
+            pxServer->xNextRelease += pxServer->xPeriod;
+
+            if( prvArrival( pxServer, xNow ) != pdFALSE )
+            {
+                xRerank = pdTRUE;
+            }
+        }
+
+        if( ( pxServer->xTask != xCurrent ) || ( pxServer->uxPending == 0U ) )
+        {
+            continue;
+        }
+
+        if( pxServer->xThrottled != pdFALSE )
+        {
+            if( pxServer->xHard != pdFALSE )
+            {
+                pxServer->xDebt++;
+            }
+
+            continue;
+        }
+
+        if( pxServer->xRemaining > 0 )
+        {
+            pxServer->xRemaining--;
+        }
+
+        if( pxServer->xRemaining == 0 )
+        {
+            /* Budget exhausted: wait below the fixed priority tasks until
+             * the deadline, so the overrun cannot take time from them. */
+            pxServer->ulPostponements++;
+            pxServer->xThrottled = pdTRUE;
+            pxServer->xThrottledUntil = pxServer->xDeadline;
+            xRerank = pdTRUE;
+        }
+    }
+
+    if( ( xRerank != pdFALSE ) && ( xRerankPending == pdFALSE ) )
+    {
+        if( xTimerPendFunctionCallFromISR( prvRerank, NULL, 0, &xHigherPriorityTaskWoken ) == pdPASS )
+        {
+            xRerankPending = pdTRUE;
+        }
+
+        portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,107 @@
+/*
+ * Constant Bandwidth Server reservations for soft real-time tasks.
+ *
+ * Each server owns a budget Q and a period P and serves one task.  Servers
+ * are scheduled EDF on their server deadlines: the active server with the
+ * earliest deadline runs at ipsaCBS_RUN_PRIORITY, every other server waits at
+ * ipsaCBS_WAIT_PRIORITY.  Execution is charged one tick at a time from
+ * vIpsaCbsTickHook().  A server that uses up its budget is throttled: it
+ * drops to ipsaCBS_WAIT_PRIORITY, below the fixed priority tasks, until its
+ * current deadline, when the budget is replenished and the deadline
+ * postponed by P.  An overrunning job therefore only delays itself, whether
+ * other servers are active or not.  While throttled the task still runs in
+ * the idle time; a hard server has that time taken off its next budgets, a
+ * soft one gets it for free.
+ *
+ * Job arrivals are either signalled with vIpsaCbsJobArrival() or, for a
+ * periodic task, registered by the tick hook at each release after
+ * vIpsaCbsPeriodicReleases(), so a server parked at ipsaCBS_WAIT_PRIORITY
+ * does not have to be dispatched before its job counts as released.
+ *
+ * Requirements: vIpsaCbsTickHook() must be called from vApplicationTickHook()
+ * (configUSE_TICK_HOOK 1) and INCLUDE_xTimerPendFunctionCall must be 1, the
+ * priority changes are deferred to the timer daemon task.
+ */
+
+#ifndef IPSA_CBS_H
+#define IPSA_CBS_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#ifndef ipsaCBS_MAX_SERVERS
+    #define ipsaCBS_MAX_SERVERS            ( 4 )
+#endif
+
+/* Priority of the server holding the earliest deadline. */
+#ifndef ipsaCBS_RUN_PRIORITY
+    #define ipsaCBS_RUN_PRIORITY           ( tskIDLE_PRIORITY + 4 )
+#endif
+
+/* Priority of every other server, and of throttled ones. */
+#ifndef ipsaCBS_WAIT_PRIORITY
+    #define ipsaCBS_WAIT_PRIORITY          ( tskIDLE_PRIORITY )
+#endif
+
+/* Total bandwidth, in per mille, admitted across all servers. */
+#ifndef ipsaCBS_MAX_BANDWIDTH
+    #define ipsaCBS_MAX_BANDWIDTH          ( 1000UL )
+#endif
+
+typedef struct IPSA_CBS_SERVER
+{
+    TaskHandle_t xTask;            /* Task served by this reservation. */
+    TickType_t xBudget;            /* Q: budget per server period. */
+    TickType_t xPeriod;            /* P: server period. */
+    TickType_t xRemaining;         /* Budget left before the server is throttled. */
+    TickType_t xDeadline;          /* Current absolute server deadline. */
+    TickType_t xThrottledUntil;    /* Replenishment time of a throttled server. */
+    TickType_t xDebt;              /* Ticks run while throttled, owed by a hard server. */
+    TickType_t xNextRelease;       /* Next periodic release, see vIpsaCbsPeriodicReleases(). */
+    BaseType_t xHard;              /* pdTRUE to charge the time run while throttled. */
+    BaseType_t xPeriodic;          /* pdTRUE if the tick hook registers the releases. */
+    UBaseType_t uxPending;         /* Jobs released and not completed yet. */
+    BaseType_t xThrottled;
+    uint32_t ulJobs;               /* Jobs served. */
+    uint32_t ulPostponements;      /* Budget exhaustions, i.e. overruns of Q. */
+} IpsaCbsServer_t;
+
+/*
+ * Registers a server with budget xBudget every xPeriod ticks for xTask.
+ * Returns pdFAIL if the total admitted bandwidth would exceed
+ * ipsaCBS_MAX_BANDWIDTH or no server slot is left.
+ */
+BaseType_t xIpsaCbsCreate( IpsaCbsServer_t * pxServer,
+                           TaskHandle_t xTask,
+                           TickType_t xBudget,
+                           TickType_t xPeriod,
+                           BaseType_t xHard );
+
+/*
+ * Has the tick hook register a job arrival every xPeriod ticks of the
+ * server, the first one at tick xFirstRelease.  The served task must be
+ * released at the same ticks, with vTaskDelayUntil() for instance.
+ */
+void vIpsaCbsPeriodicReleases( IpsaCbsServer_t * pxServer,
+                               TickType_t xFirstRelease );
+
+/*
+ * Called when a new job of the served task is released, by the task that
+ * releases it.  If the server was idle, applies the CBS arrival rule (keep
+ * the current deadline if the remaining budget still fits its bandwidth,
+ * otherwise start a fresh period) and re-ranks the servers.
+ */
+void vIpsaCbsJobArrival( IpsaCbsServer_t * pxServer );
+
+/*
+ * Called by the served task when its job completes; once no job is pending
+ * the server goes idle and the next server in deadline order is promoted.
+ */
+void vIpsaCbsJobComplete( IpsaCbsServer_t * pxServer );
+
+/*
+ * Budget accounting, call from vApplicationTickHook().
+ */
+void vIpsaCbsTickHook( void );
+
+#endif /* IPSA_CBS_H */
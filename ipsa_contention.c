@@ -0,0 +1,425 @@
+/*
+ * Lock contention profiler, see ipsa_contention.h.
+ */
+
+#include <string.h>
+#include <time.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Local includes. */
+#include "ipsa_contention.h"
+
+/* A task blocked on an object, since its first block for this operation. */
+typedef struct CONTENTION_WAITER
+{
+    TaskHandle_t xTask;
+    void * pvObject;
+    eIpsaContentionSide eSide;
+    uint64_t ullSince;
+} ContentionWaiter_t;
+
+/*-----------------------------------------------------------*/
+
+static IpsaContentionObject_t xObjects[ ipsaCONTENTION_MAX_OBJECTS ];
+static size_t uxObjects = 0;
+
+static IpsaContentionEdge_t xEdges[ ipsaCONTENTION_MAX_EDGES ];
+static size_t uxEdges = 0;
+
+static ContentionWaiter_t xWaiters[ ipsaCONTENTION_MAX_TASKS ];
+
+static const char * const pcTypes[] =
+{
+    "queue", "mutex", "counting", "binary", "recursive"
+};
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNow( void );
+
+/* Name of the running task, or of main() before the scheduler starts. */
+static void prvTaskName( char * pcName );
+
+/*
+ * Returns the entry of pvObject, adding it if needed, or NULL if the table
+ * is full.  prvWaiter() does the same for xTask, adding it only if xCreate
+ * is pdTRUE.
+ */
+static IpsaContentionObject_t * prvObject( void * pvObject );
+static ContentionWaiter_t * prvWaiter( TaskHandle_t xTask,
+                                       BaseType_t xCreate );
+
+/*
+ * Ends the wait of the running task on pvObject, if it was waiting, and
+ * charges it to the object and to the culprit.  Returns pdTRUE if it was.
+ */
+static BaseType_t prvEndWait( IpsaContentionObject_t * pxObject,
+                              eIpsaContentionSide eSide,
+                              const char * pcWaiter,
+                              const char * pcCulprit );
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNow( void )
+{
+    struct timespec xTime;
+
+    clock_gettime( CLOCK_MONOTONIC, &xTime );
+
+    return ( ( uint64_t ) xTime.tv_sec * 1000000000ULL ) + ( uint64_t ) xTime.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTaskName( char * pcName )
+{
+    const char * pcTask = "main";
+
+    if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+    {
+        pcTask = pcTaskGetName( NULL );
+    }
+
+    strncpy( pcName, pcTask, ipsaCONTENTION_NAME_LEN - 1U );
+    pcName[ ipsaCONTENTION_NAME_LEN - 1U ] = '\0';
+}
+/*-----------------------------------------------------------*/
+
+static IpsaContentionObject_t * prvObject( void * pvObject )
+{
+    IpsaContentionObject_t * pxObject;
+    size_t x;
+
+    for( x = 0; x < uxObjects; x++ )
+    {
+        if( xObjects[ x ].pvObject == pvObject )
+        {
+            return &xObjects[ x ];
+        }
+    }
+
+    if( uxObjects == ipsaCONTENTION_MAX_OBJECTS )
+    {
+        return NULL;
+    }
+
+    pxObject = &xObjects[ uxObjects++ ];
+    memset( pxObject, 0, sizeof( *pxObject ) );
+    pxObject->pvObject = pvObject;
+    pxObject->ucType = ucQueueGetQueueType( ( QueueHandle_t ) pvObject );
+    strcpy( pxObject->cLast[ eIpsaContentionTake ], "-" );
+    strcpy( pxObject->cLast[ eIpsaContentionGive ], "-" );
+
+    return pxObject;
+}
+/*-----------------------------------------------------------*/
+
+static ContentionWaiter_t * prvWaiter( TaskHandle_t xTask,
+                                       BaseType_t xCreate )
+{
+    ContentionWaiter_t * pxFree = NULL;
+    size_t x;
+
+    for( x = 0; x < ipsaCONTENTION_MAX_TASKS; x++ )
+    {
+        if( xWaiters[ x ].xTask == xTask )
+        {
+            return &xWaiters[ x ];
+        }
+
+        if( ( pxFree == NULL ) && ( xWaiters[ x ].xTask == NULL ) )
+        {
+            pxFree = &xWaiters[ x ];
+        }
+    }
+
+    if( xCreate == pdFALSE )
+    {
+        return NULL;
+    }
+
+    if( pxFree != NULL )
+    {
+        pxFree->xTask = xTask;
+        pxFree->pvObject = NULL;
+    }
+
+    return pxFree;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvEndWait( IpsaContentionObject_t * pxObject,
+                              eIpsaContentionSide eSide,
+                              const char * pcWaiter,
+                              const char * pcCulprit )
+{
+    ContentionWaiter_t * pxWaiter = prvWaiter( xTaskGetCurrentTaskHandle(), pdFALSE );
+    IpsaContentionCounters_t * pxCounters = &pxObject->xSides[ eSide ];
+    IpsaContentionEdge_t * pxEdge = NULL;
+    uint64_t ullWait;
+    size_t x;
+
+    if( ( pxWaiter == NULL ) || ( pxWaiter->pvObject != pxObject->pvObject ) || ( pxWaiter->eSide != eSide ) )
+    {
+        return pdFALSE;
+    }
+
+    ullWait = prvNow() - pxWaiter->ullSince;
+    pxWaiter->xTask = NULL;
+
+    pxCounters->ullWait += ullWait;
+
+    if( ullWait > pxCounters->ullMaxWait )
+    {
+        pxCounters->ullMaxWait = ullWait;
+    }
+
+    for( x = 0; x < uxEdges; x++ )
+    {
+        if( ( xEdges[ x ].pvObject == pxObject->pvObject ) && ( xEdges[ x ].eSide == eSide ) &&
+            ( strcmp( xEdges[ x ].cWaiter, pcWaiter ) == 0 ) && ( strcmp( xEdges[ x ].cCulprit, pcCulprit ) == 0 ) )
+        {
+            pxEdge = &xEdges[ x ];
+            break;
+        }
+    }
+
+    if( ( pxEdge == NULL ) && ( uxEdges < ipsaCONTENTION_MAX_EDGES ) )
+    {
+        pxEdge = &xEdges[ uxEdges++ ];
+        memset( pxEdge, 0, sizeof( *pxEdge ) );
+        pxEdge->pvObject = pxObject->pvObject;
+        pxEdge->eSide = eSide;
+        strcpy( pxEdge->cWaiter, pcWaiter );
+        strcpy( pxEdge->cCulprit, pcCulprit );
+    }
+
+    if( pxEdge != NULL )
+    {
+        pxEdge->ulWaits++;
+        pxEdge->ullWait += ullWait;
+    }
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaContentionBlocking( void * pvObject,
+                              eIpsaContentionSide eSide )
+{
+    ContentionWaiter_t * pxWaiter;
+
+    /* Called with the scheduler suspended, ISRs may still use the tables. */
+    taskENTER_CRITICAL();
+    {
+        pxWaiter = prvWaiter( xTaskGetCurrentTaskHandle(), pdTRUE );
+
+        /* Blocking again after losing the object keeps the first time. */
+        if( ( pxWaiter != NULL ) && ( ( pxWaiter->pvObject != pvObject ) || ( pxWaiter->eSide != eSide ) ) )
+        {
+            pxWaiter->pvObject = pvObject;
+            pxWaiter->eSide = eSide;
+            pxWaiter->ullSince = prvNow();
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaContentionDone( void * pvObject,
+                          eIpsaContentionSide eSide )
+{
+    IpsaContentionObject_t * pxObject;
+    eIpsaContentionSide eOther = ( eSide == eIpsaContentionTake ) ? eIpsaContentionGive : eIpsaContentionTake;
+    char cName[ ipsaCONTENTION_NAME_LEN ];
+
+    prvTaskName( cName );
+
+    taskENTER_CRITICAL();
+    {
+        pxObject = prvObject( pvObject );
+
+        if( pxObject != NULL )
+        {
+            pxObject->xSides[ eSide ].ulOperations++;
+
+            if( prvEndWait( pxObject, eSide, cName, pxObject->cLast[ eOther ] ) != pdFALSE )
+            {
+                pxObject->xSides[ eSide ].ulContended++;
+            }
+
+            strcpy( pxObject->cLast[ eSide ], cName );
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaContentionDoneFromISR( void * pvObject,
+                                 eIpsaContentionSide eSide )
+{
+    IpsaContentionObject_t * pxObject = prvObject( pvObject );
+
+    /* Runs with interrupts masked.  ISRs never block. */
+    if( pxObject != NULL )
+    {
+        pxObject->xSides[ eSide ].ulOperations++;
+        strcpy( pxObject->cLast[ eSide ], "ISR" );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaContentionFailed( void * pvObject,
+                            eIpsaContentionSide eSide )
+{
+    IpsaContentionObject_t * pxObject;
+    eIpsaContentionSide eOther = ( eSide == eIpsaContentionTake ) ? eIpsaContentionGive : eIpsaContentionTake;
+    char cName[ ipsaCONTENTION_NAME_LEN ];
+    const char * pcCulprit;
+
+    prvTaskName( cName );
+
+    taskENTER_CRITICAL();
+    {
+        pxObject = prvObject( pvObject );
+
+        if( pxObject != NULL )
+        {
+            /* A mutex still taken is held by its last taker. */
+            pcCulprit = pxObject->cLast[ eOther ];
+
+            if( ( pxObject->ucType == queueQUEUE_TYPE_MUTEX ) || ( pxObject->ucType == queueQUEUE_TYPE_RECURSIVE_MUTEX ) )
+            {
+                pcCulprit = pxObject->cLast[ eIpsaContentionTake ];
+            }
+
+            /* Failing without blocking is not a timeout. */
+            if( prvEndWait( pxObject, eSide, cName, pcCulprit ) != pdFALSE )
+            {
+                pxObject->xSides[ eSide ].ulTimeouts++;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaContentionDeleted( void * pvObject )
+{
+    size_t x, y = 0;
+
+    taskENTER_CRITICAL();
+    {
+        /* The address may be reused by a new object, forget this one. */
+        for( x = 0; x < uxObjects; x++ )
+        {
+            if( xObjects[ x ].pvObject != pvObject )
+            {
+                xObjects[ y++ ] = xObjects[ x ];
+            }
+        }
+
+        uxObjects = y;
+        y = 0;
+
+        for( x = 0; x < uxEdges; x++ )
+        {
+            if( xEdges[ x ].pvObject != pvObject )
+            {
+                xEdges[ y++ ] = xEdges[ x ];
+            }
+        }
+
+        uxEdges = y;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+size_t uxIpsaContentionObjects( IpsaContentionObject_t * pxObjects,
+                                size_t uxMax )
+{
+    static IpsaContentionObject_t xCopy[ ipsaCONTENTION_MAX_OBJECTS ];
+    IpsaContentionObject_t xObject;
+    uint64_t ullWait;
+    size_t uxCount, x, y;
+
+    taskENTER_CRITICAL();
+    {
+        uxCount = uxObjects;
+        memcpy( xCopy, xObjects, uxCount * sizeof( xObjects[ 0 ] ) );
+    }
+    taskEXIT_CRITICAL();
+
+    /* Insertion sort, longest total wait over both sides first. */
+    for( x = 1; x < uxCount; x++ )
+    {
+        xObject = xCopy[ x ];
+        ullWait = xObject.xSides[ eIpsaContentionTake ].ullWait + xObject.xSides[ eIpsaContentionGive ].ullWait;
+
+        for( y = x; ( y > 0U ) &&
+             ( ( xCopy[ y - 1U ].xSides[ eIpsaContentionTake ].ullWait + xCopy[ y - 1U ].xSides[ eIpsaContentionGive ].ullWait ) < ullWait );
+             y-- )
+        {
+            xCopy[ y ] = xCopy[ y - 1U ];
+        }
+
+        xCopy[ y ] = xObject;
+    }
+
+    if( uxCount > uxMax )
+    {
+        uxCount = uxMax;
+    }
+
+    memcpy( pxObjects, xCopy, uxCount * sizeof( xCopy[ 0 ] ) );
+
+    return uxCount;
+}
+/*-----------------------------------------------------------*/
+
+size_t uxIpsaContentionEdges( IpsaContentionEdge_t * pxEdges,
+                              size_t uxMax )
+{
+    static IpsaContentionEdge_t xCopy[ ipsaCONTENTION_MAX_EDGES ];
+    IpsaContentionEdge_t xEdge;
+    size_t uxCount, x, y;
+
+    taskENTER_CRITICAL();
+    {
+        uxCount = uxEdges;
+        memcpy( xCopy, xEdges, uxCount * sizeof( xEdges[ 0 ] ) );
+    }
+    taskEXIT_CRITICAL();
+
+    for( x = 1; x < uxCount; x++ )
+    {
+        xEdge = xCopy[ x ];
+
+        for( y = x; ( y > 0U ) && ( xCopy[ y - 1U ].ullWait < xEdge.ullWait ); y-- )
+        {
+            xCopy[ y ] = xCopy[ y - 1U ];
+        }
+
+        xCopy[ y ] = xEdge;
+    }
+
+    if( uxCount > uxMax )
+    {
+        uxCount = uxMax;
+    }
+
+    memcpy( pxEdges, xCopy, uxCount * sizeof( xCopy[ 0 ] ) );
+
+    return uxCount;
+}
+/*-----------------------------------------------------------*/
+
+const char * pcIpsaContentionType( uint8_t ucType )
+{
+    return ( ucType < ( sizeof( pcTypes ) / sizeof( pcTypes[ 0 ] ) ) ) ? pcTypes[ ucType ] : "?";
+}
+/*-----------------------------------------------------------*/
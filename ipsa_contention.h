@@ -0,0 +1,126 @@
+/*
+ * Lock contention profiler for mutexes, semaphores and queues.
+ *
+ * Every queue, semaphore and mutex, xQueue and the queue sets included, is
+ * followed from the kernel's queue trace hooks.  Each object counts, for its
+ * take side (receive, take, peek) and its give side (send, give):
+ *   - the operations that succeeded,
+ *   - the ones that had to block first, contended,
+ *   - the blocks that timed out,
+ *   - the total and the longest time spent blocked.
+ * A wait is charged from the first time a task blocks on an object to the
+ * operation that ends it, so a task woken up and beaten to the object keeps
+ * waiting.  Each wait is also charged to a waiter and culprit pair: the
+ * culprit is the last task, or ISR, to act on the other side, which is the
+ * holder that gave a mutex back, the producer that gave a semaphore or a
+ * message, or the consumer that made room.  A mutex wait that times out is
+ * charged to the current holder.
+ *
+ * A consumer waiting on an empty queue or an event semaphore is counted as
+ * contended as well; the culprit then tells idle waiting from a hot lock.
+ * Waits on a queue set have no culprit, the member sent to names it.
+ *
+ * Requirements: FreeRTOSConfig.h must route the queue trace hooks here,
+ *     #define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )    vIpsaContentionBlocking( pxQueue, eIpsaContentionTake )
+ *     #define traceBLOCKING_ON_QUEUE_PEEK( pxQueue )       vIpsaContentionBlocking( pxQueue, eIpsaContentionTake )
+ *     #define traceBLOCKING_ON_QUEUE_SEND( pxQueue )       vIpsaContentionBlocking( pxQueue, eIpsaContentionGive )
+ *     #define traceQUEUE_RECEIVE( pxQueue )                vIpsaContentionDone( pxQueue, eIpsaContentionTake )
+ *     #define traceQUEUE_PEEK( pxQueue )                   vIpsaContentionDone( pxQueue, eIpsaContentionTake )
+ *     #define traceQUEUE_SEND( pxQueue )                   vIpsaContentionDone( pxQueue, eIpsaContentionGive )
+ *     #define traceQUEUE_RECEIVE_FROM_ISR( pxQueue )       vIpsaContentionDoneFromISR( pxQueue, eIpsaContentionTake )
+ *     #define traceQUEUE_SEND_FROM_ISR( pxQueue )          vIpsaContentionDoneFromISR( pxQueue, eIpsaContentionGive )
+ *     #define traceQUEUE_RECEIVE_FAILED( pxQueue )         vIpsaContentionFailed( pxQueue, eIpsaContentionTake )
+ *     #define traceQUEUE_PEEK_FAILED( pxQueue )            vIpsaContentionFailed( pxQueue, eIpsaContentionTake )
+ *     #define traceQUEUE_SEND_FAILED( pxQueue )            vIpsaContentionFailed( pxQueue, eIpsaContentionGive )
+ *     #define traceQUEUE_DELETE( pxQueue )                 vIpsaContentionDeleted( pxQueue )
+ * with ipsa_contention.h included by FreeRTOSConfig.h, and
+ * configUSE_TRACE_FACILITY must be 1.  Objects are named by the queue
+ * registry when configQUEUE_REGISTRY_SIZE is not 0.
+ */
+
+#ifndef IPSA_CONTENTION_H
+#define IPSA_CONTENTION_H
+
+/* Included from FreeRTOSConfig.h, so no kernel header here. */
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef ipsaCONTENTION_MAX_OBJECTS
+    #define ipsaCONTENTION_MAX_OBJECTS     ( 32 )
+#endif
+
+/* Tasks that may be blocked on an object at the same time. */
+#ifndef ipsaCONTENTION_MAX_TASKS
+    #define ipsaCONTENTION_MAX_TASKS       ( 16 )
+#endif
+
+/* Distinct object, side, waiter and culprit combinations. */
+#ifndef ipsaCONTENTION_MAX_EDGES
+    #define ipsaCONTENTION_MAX_EDGES       ( 48 )
+#endif
+
+#ifndef ipsaCONTENTION_NAME_LEN
+    #define ipsaCONTENTION_NAME_LEN        ( 16 )
+#endif
+
+typedef enum
+{
+    eIpsaContentionTake = 0,
+    eIpsaContentionGive,
+    eIpsaContentionSides
+} eIpsaContentionSide;
+
+typedef struct IPSA_CONTENTION_COUNTERS
+{
+    uint32_t ulOperations;
+    uint32_t ulContended;
+    uint32_t ulTimeouts;
+    uint64_t ullWait;
+    uint64_t ullMaxWait;
+} IpsaContentionCounters_t;
+
+typedef struct IPSA_CONTENTION_OBJECT
+{
+    void * pvObject;
+    uint8_t ucType;                                                        /* queueQUEUE_TYPE_xxx. */
+    IpsaContentionCounters_t xSides[ eIpsaContentionSides ];
+    char cLast[ eIpsaContentionSides ][ ipsaCONTENTION_NAME_LEN ];         /* Last task to act on each side. */
+} IpsaContentionObject_t;
+
+typedef struct IPSA_CONTENTION_EDGE
+{
+    void * pvObject;
+    eIpsaContentionSide eSide;
+    char cWaiter[ ipsaCONTENTION_NAME_LEN ];
+    char cCulprit[ ipsaCONTENTION_NAME_LEN ];
+    uint32_t ulWaits;
+    uint64_t ullWait;
+} IpsaContentionEdge_t;
+
+/*
+ * Trace hooks, see the requirements above.  They take the queue as a
+ * void pointer so this header does not need queue.h.
+ */
+void vIpsaContentionBlocking( void * pvObject,
+                              eIpsaContentionSide eSide );
+void vIpsaContentionDone( void * pvObject,
+                          eIpsaContentionSide eSide );
+void vIpsaContentionDoneFromISR( void * pvObject,
+                                 eIpsaContentionSide eSide );
+void vIpsaContentionFailed( void * pvObject,
+                            eIpsaContentionSide eSide );
+void vIpsaContentionDeleted( void * pvObject );
+
+/*
+ * Copy up to uxMax objects, or edges, into the buffer given, longest total
+ * wait first, and return how many were copied.
+ */
+size_t uxIpsaContentionObjects( IpsaContentionObject_t * pxObjects,
+                                size_t uxMax );
+size_t uxIpsaContentionEdges( IpsaContentionEdge_t * pxEdges,
+                              size_t uxMax );
+
+/* Short name of a queueQUEUE_TYPE_xxx value, for reports. */
+const char * pcIpsaContentionType( uint8_t ucType );
+
+#endif /* IPSA_CONTENTION_H */
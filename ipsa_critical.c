@@ -0,0 +1,259 @@
+/*
+ * Critical section and scheduler suspend profiler, see ipsa_critical.h.
+ */
+
+#define _GNU_SOURCE
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "ipsa_critical.h"
+
+/* The kernel's own functions, renamed by the linker's --wrap. */
+extern void __real_vPortEnterCritical( void );
+extern void __real_vPortExitCritical( void );
+extern void __real_vTaskSuspendAll( void );
+extern BaseType_t __real_xTaskResumeAll( void );
+
+void __wrap_vPortEnterCritical( void );
+void __wrap_vPortExitCritical( void );
+void __wrap_vTaskSuspendAll( void );
+BaseType_t __wrap_xTaskResumeAll( void );
+
+/* The outermost region of each kind in progress. */
+typedef struct CRITICAL_REGION
+{
+    UBaseType_t uxDepth;
+    const void * pvSite;
+    uint64_t ullStart;
+} CriticalRegion_t;
+
+/*-----------------------------------------------------------*/
+
+static IpsaCriticalSite_t xSites[ ipsaCRITICAL_MAX_SITES ];
+static UBaseType_t uxSites = 0;
+static uint32_t ulDropped = 0;
+
+static CriticalRegion_t xRegions[ 2 ];
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNow( void );
+
+/*
+ * Charges ullNanoseconds to the site pvSite of kind eKind.  Must be called
+ * with interrupts masked.
+ */
+static void prvRecord( const void * pvSite,
+                       eIpsaCriticalKind eKind,
+                       uint64_t ullNanoseconds );
+
+static void prvEnter( eIpsaCriticalKind eKind,
+                      const void * pvSite );
+static void prvExit( eIpsaCriticalKind eKind );
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNow( void )
+{
+    struct timespec xTime;
+
+    clock_gettime( CLOCK_MONOTONIC, &xTime );
+
+    return ( ( uint64_t ) xTime.tv_sec * 1000000000ULL ) + ( uint64_t ) xTime.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRecord( const void * pvSite,
+                       eIpsaCriticalKind eKind,
+                       uint64_t ullNanoseconds )
+{
+    IpsaCriticalSite_t * pxSite = NULL;
+    uint64_t ullScaled = ullNanoseconds >> ipsaCRITICAL_SHIFT;
+    UBaseType_t x, uxBucket = 0;
+
+    for( x = 0; x < uxSites; x++ )
+    {
+        if( ( xSites[ x ].pvSite == pvSite ) && ( xSites[ x ].eKind == eKind ) )
+        {
+            pxSite = &xSites[ x ];
+            break;
+        }
+    }
+
+    if( pxSite == NULL )
+    {
+        if( uxSites == ipsaCRITICAL_MAX_SITES )
+        {
+            ulDropped++;
+            return;
+        }
+
+        pxSite = &xSites[ uxSites++ ];
+        pxSite->pvSite = pvSite;
+        pxSite->eKind = eKind;
+    }
+
+    if( ullScaled != 0U )
+    {
+        uxBucket = ( UBaseType_t ) ( 63 - __builtin_clzll( ullScaled ) );
+
+        if( uxBucket >= ipsaCRITICAL_BUCKETS )
+        {
+            uxBucket = ipsaCRITICAL_BUCKETS - 1U;
+        }
+    }
+
+    if( ullNanoseconds > pxSite->ullMax )
+    {
+        pxSite->ullMax = ullNanoseconds;
+    }
+
+    pxSite->ullTotal += ullNanoseconds;
+    pxSite->ulCount++;
+    pxSite->ulHistogram[ uxBucket ]++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvEnter( eIpsaCriticalKind eKind,
+                      const void * pvSite )
+{
+    CriticalRegion_t * pxRegion = &xRegions[ eKind ];
+
+    if( pxRegion->uxDepth++ == 0U )
+    {
+        pxRegion->pvSite = pvSite;
+        pxRegion->ullStart = prvNow();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvExit( eIpsaCriticalKind eKind )
+{
+    CriticalRegion_t * pxRegion = &xRegions[ eKind ];
+
+    /* An exit without an entry seen, the profiler was linked in late. */
+    if( pxRegion->uxDepth == 0U )
+    {
+        return;
+    }
+
+    if( --pxRegion->uxDepth == 0U )
+    {
+        prvRecord( pxRegion->pvSite, eKind, prvNow() - pxRegion->ullStart );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void __wrap_vPortEnterCritical( void )
+{
+    const void * pvSite = __builtin_return_address( 0 );
+
+    __real_vPortEnterCritical();
+    prvEnter( eIpsaCriticalSection, pvSite );
+}
+/*-----------------------------------------------------------*/
+
+void __wrap_vPortExitCritical( void )
+{
+    prvExit( eIpsaCriticalSection );
+    __real_vPortExitCritical();
+}
+/*-----------------------------------------------------------*/
+
+void __wrap_vTaskSuspendAll( void )
+{
+    const void * pvSite = __builtin_return_address( 0 );
+
+    __real_vTaskSuspendAll();
+
+    /* Interrupts still run while the scheduler is suspended. */
+    __real_vPortEnterCritical();
+    prvEnter( eIpsaCriticalSuspend, pvSite );
+    __real_vPortExitCritical();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t __wrap_xTaskResumeAll( void )
+{
+    __real_vPortEnterCritical();
+    prvExit( eIpsaCriticalSuspend );
+    __real_vPortExitCritical();
+
+    return __real_xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxIpsaCriticalSnapshot( IpsaCriticalSite_t * pxSites,
+                                    UBaseType_t uxMax,
+                                    uint32_t * pulDropped )
+{
+    static IpsaCriticalSite_t xCopy[ ipsaCRITICAL_MAX_SITES ];
+    IpsaCriticalSite_t xSite;
+    UBaseType_t uxCount, x, y;
+
+    __real_vPortEnterCritical();
+    {
+        uxCount = uxSites;
+        memcpy( xCopy, xSites, uxCount * sizeof( xSites[ 0 ] ) );
+
+        if( pulDropped != NULL )
+        {
+            *pulDropped = ulDropped;
+        }
+    }
+    __real_vPortExitCritical();
+
+    /* Insertion sort, longest maximum first. */
+    for( x = 1; x < uxCount; x++ )
+    {
+        xSite = xCopy[ x ];
+
+        for( y = x; ( y > 0U ) && ( xCopy[ y - 1U ].ullMax < xSite.ullMax ); y-- )
+        {
+            xCopy[ y ] = xCopy[ y - 1U ];
+        }
+
+        xCopy[ y ] = xSite;
+    }
+
+    if( uxCount > uxMax )
+    {
+        uxCount = uxMax;
+    }
+
+    memcpy( pxSites, xCopy, uxCount * sizeof( xCopy[ 0 ] ) );
+
+    return uxCount;
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaCriticalSiteName( const void * pvSite,
+                            char * pcBuffer,
+                            size_t uxSize )
+{
+    Dl_info xInfo;
+
+    if( dladdr( pvSite, &xInfo ) == 0 )
+    {
+        snprintf( pcBuffer, uxSize, "%p", pvSite );
+    }
+    else if( xInfo.dli_sname != NULL )
+    {
+        snprintf( pcBuffer, uxSize, "%s+0x%lx [0x%lx]", xInfo.dli_sname,
+                  ( unsigned long ) ( ( const char * ) pvSite - ( const char * ) xInfo.dli_saddr ),
+                  ( unsigned long ) ( ( const char * ) pvSite - ( const char * ) xInfo.dli_fbase ) );
+    }
+    else
+    {
+        snprintf( pcBuffer, uxSize, "[0x%lx]", ( unsigned long ) ( ( const char * ) pvSite - ( const char * ) xInfo.dli_fbase ) );
+    }
+}
+/*-----------------------------------------------------------*/
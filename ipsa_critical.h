@@ -0,0 +1,82 @@
+/*
+ * Critical section and scheduler suspend duration profiler.
+ *
+ * Every outermost taskENTER_CRITICAL() / taskEXIT_CRITICAL() pair and every
+ * outermost vTaskSuspendAll() / xTaskResumeAll() pair is timed with
+ * CLOCK_MONOTONIC and charged to its call site, the return address of the
+ * entry call.  Sites in the kernel, such as the queue and timer operations
+ * behind prvQueueSendTimerCallback(), are found the same way as the ones in
+ * the application.  Each site keeps its count, total, maximum and a
+ * histogram with power of two buckets, so the sections that add most to the
+ * worst case latency stand out.
+ *
+ * The time measured is the time spent with interrupts masked or the
+ * scheduler suspended, entry and exit bookkeeping excluded.  On the Linux
+ * port a yield inside a critical section switches tasks at once, and the
+ * section is then charged the time the other task ran.
+ *
+ * Requirements: the entry and exit functions are interposed by the linker,
+ * so the kernel is used unmodified.  Link with
+ *     -Wl,--wrap=vPortEnterCritical,--wrap=vPortExitCritical
+ *     -Wl,--wrap=vTaskSuspendAll,--wrap=xTaskResumeAll
+ * and with -rdynamic for the site names (-ldl before glibc 2.34).  The port
+ * must implement portENTER_CRITICAL() with vPortEnterCritical(), as the
+ * Linux port does.  Calls from tasks.c to its own vTaskSuspendAll(), in
+ * vTaskDelay() for instance, do not go through the linker and are not seen.
+ */
+
+#ifndef IPSA_CRITICAL_H
+#define IPSA_CRITICAL_H
+
+#include "FreeRTOS.h"
+
+#ifndef ipsaCRITICAL_MAX_SITES
+    #define ipsaCRITICAL_MAX_SITES         ( 48 )
+#endif
+
+/* Histogram buckets; bucket b counts durations in
+ * [ 2^( b + SHIFT ), 2^( b + 1 + SHIFT ) ) ns, the first and last ones are
+ * open ended. */
+#ifndef ipsaCRITICAL_BUCKETS
+    #define ipsaCRITICAL_BUCKETS           ( 16 )
+#endif
+
+#ifndef ipsaCRITICAL_SHIFT
+    #define ipsaCRITICAL_SHIFT             ( 6 )
+#endif
+
+typedef enum
+{
+    eIpsaCriticalSection = 0,   /* Interrupts masked. */
+    eIpsaCriticalSuspend        /* Scheduler suspended. */
+} eIpsaCriticalKind;
+
+typedef struct IPSA_CRITICAL_SITE
+{
+    const void * pvSite;
+    eIpsaCriticalKind eKind;
+    uint32_t ulCount;
+    uint64_t ullTotal;
+    uint64_t ullMax;
+    uint32_t ulHistogram[ ipsaCRITICAL_BUCKETS ];
+} IpsaCriticalSite_t;
+
+/*
+ * Copies up to uxMax sites into pxSites, longest maximum first, and returns
+ * how many were copied.  *pulDropped, if not NULL, receives the number of
+ * sections not recorded because the site table was full.
+ */
+UBaseType_t uxIpsaCriticalSnapshot( IpsaCriticalSite_t * pxSites,
+                                    UBaseType_t uxMax,
+                                    uint32_t * pulDropped );
+
+/*
+ * Writes the name of a site, "function+0xoffset [0xaddress]", into pcBuffer.
+ * The address is relative to the module so addr2line can resolve static
+ * functions, which the name alone may hide.
+ */
+void vIpsaCriticalSiteName( const void * pvSite,
+                            char * pcBuffer,
+                            size_t uxSize );
+
+#endif /* IPSA_CRITICAL_H */
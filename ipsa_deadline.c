@@ -0,0 +1,160 @@
+/*
+ * Deadline inheritance for message consumers, see ipsa_deadline.h.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "ipsa_deadline.h"
+
+/*-----------------------------------------------------------*/
+
+/* Returns pdTRUE if tick a is before tick b, taking wrap around into account. */
+static BaseType_t prvBefore( TickType_t a,
+                             TickType_t b );
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvBefore( TickType_t a,
+                             TickType_t b )
+{
+    return ( ( TickType_t ) ( a - b ) > ( portMAX_DELAY / 2U ) ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxIpsaDeadlineBands( const IpsaTask_t * pxTasks,
+                                 size_t uxCount,
+                                 IpsaDeadlineBand_t * pxBands )
+{
+    size_t x;
+    uint32_t ulDeadline;
+
+    for( x = 0; x < uxCount; x++ )
+    {
+        ulDeadline = ( pxTasks[ x ].ulDeadline != 0U ) ? pxTasks[ x ].ulDeadline : pxTasks[ x ].ulPeriod;
+        pxBands[ x ].xDeadline = pdMS_TO_TICKS( ulDeadline );
+        pxBands[ x ].uxPriority = ( UBaseType_t ) pxTasks[ x ].ulPriority;
+    }
+
+    return ( UBaseType_t ) uxCount;
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaDeadlineInit( IpsaDeadlineInheritor_t * pxInheritor,
+                        TaskHandle_t xTask,
+                        const IpsaDeadlineBand_t * pxBands,
+                        UBaseType_t uxBands )
+{
+    pxInheritor->xTask = xTask;
+    pxInheritor->uxBasePriority = uxTaskPriorityGet( xTask );
+    pxInheritor->pxBands = pxBands;
+    pxInheritor->uxBands = uxBands;
+    pxInheritor->xInherited = pdFALSE;
+    pxInheritor->xFresh = pdFALSE;
+    pxInheritor->xDeadline = 0;
+    pxInheritor->uxPriority = 0;
+    pxInheritor->ulBoosts = 0;
+    pxInheritor->ulLate = 0;
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaDeadlineInherit( IpsaDeadlineInheritor_t * pxInheritor,
+                           TickType_t xDeadline )
+{
+    TickType_t xNow = xTaskGetTickCount();
+    TickType_t xLeft = 0;
+    UBaseType_t uxPriority = pxInheritor->uxBasePriority, x;
+    const IpsaDeadlineBand_t * pxBand, * pxChosen = NULL;
+
+    if( prvBefore( xNow, xDeadline ) != pdFALSE )
+    {
+        xLeft = xDeadline - xNow;
+    }
+
+    /* Deadline monotonic: the priority of the task with the shortest
+     * relative deadline that still covers the time left, the most urgent
+     * one among equal deadlines. */
+    for( x = 0; x < pxInheritor->uxBands; x++ )
+    {
+        pxBand = &pxInheritor->pxBands[ x ];
+
+        if( ( pxBand->xDeadline >= xLeft ) &&
+            ( ( pxChosen == NULL ) ||
+              ( pxBand->xDeadline < pxChosen->xDeadline ) ||
+              ( ( pxBand->xDeadline == pxChosen->xDeadline ) && ( pxBand->uxPriority > pxChosen->uxPriority ) ) ) )
+        {
+            pxChosen = pxBand;
+        }
+    }
+
+    if( ( pxChosen != NULL ) && ( pxChosen->uxPriority > uxPriority ) )
+    {
+        uxPriority = pxChosen->uxPriority;
+    }
+
+    /* Producer and consumer both update the state.  The priority is set
+     * inside the critical section too, so a restore cannot slip in between
+     * the decision and the raise; the kernel itself yields from within
+     * vTaskPrioritySet()'s own critical section. */
+    taskENTER_CRITICAL();
+    {
+        if( xLeft == 0U )
+        {
+            pxInheritor->ulLate++;
+        }
+
+        pxInheritor->xFresh = pdTRUE;
+
+        /* Unless already running for an earlier deadline. */
+        if( ( pxInheritor->xInherited == pdFALSE ) || ( prvBefore( xDeadline, pxInheritor->xDeadline ) != pdFALSE ) )
+        {
+            if( pxInheritor->xInherited == pdFALSE )
+            {
+                pxInheritor->uxPriority = 0;
+            }
+
+            pxInheritor->xDeadline = xDeadline;
+            pxInheritor->xInherited = pdTRUE;
+
+            if( uxPriority > uxTaskPriorityGet( pxInheritor->xTask ) )
+            {
+                vTaskPrioritySet( pxInheritor->xTask, uxPriority );
+                pxInheritor->uxPriority = uxPriority;
+                pxInheritor->ulBoosts++;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaDeadlineRestore( IpsaDeadlineInheritor_t * pxInheritor )
+{
+    BaseType_t xRestored = pdTRUE;
+
+    taskENTER_CRITICAL();
+    {
+        if( pxInheritor->xFresh != pdFALSE )
+        {
+            /* The consumer may have looked at its queue before that
+             * message was queued. */
+            pxInheritor->xFresh = pdFALSE;
+            xRestored = pdFALSE;
+        }
+        else if( pxInheritor->xInherited != pdFALSE )
+        {
+            pxInheritor->xInherited = pdFALSE;
+
+            if( ( pxInheritor->uxPriority != 0U ) && ( uxTaskPriorityGet( pxInheritor->xTask ) == pxInheritor->uxPriority ) )
+            {
+                vTaskPrioritySet( pxInheritor->xTask, pxInheritor->uxBasePriority );
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xRestored;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,82 @@
+/*
+ * Deadline inheritance for message consumers.
+ *
+ * A message stamped with an absolute deadline by the stage that produced it
+ * tells each consumer how urgent it is.  The producer calls
+ * vIpsaDeadlineInherit() for the consumer once the message is queued, so
+ * the consumer is raised while the message waits, not only once it has
+ * been dispatched.  Until it calls xIpsaDeadlineRestore() with its queue
+ * empty, the consumer runs at the priority a deadline monotonic assignment
+ * would give a job due by then, that of the task with the shortest relative
+ * deadline that is still at least the time left.  A stage that forwards the
+ * message copies the same absolute deadline into its output, so the
+ * deadline holds end to end.
+ *
+ * Tasks in an ipsaLOCAL_EDF group inherit through
+ * vIpsaGroupInheritDeadline() in ipsa_hsched.c instead.
+ */
+
+#ifndef IPSA_DEADLINE_H
+#define IPSA_DEADLINE_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ipsa_analysis.h"
+
+/* A relative deadline and the priority that meets it. */
+typedef struct IPSA_DEADLINE_BAND
+{
+    TickType_t xDeadline;
+    UBaseType_t uxPriority;
+} IpsaDeadlineBand_t;
+
+typedef struct IPSA_DEADLINE_INHERITOR
+{
+    TaskHandle_t xTask;
+    UBaseType_t uxBasePriority;
+    const IpsaDeadlineBand_t * pxBands;
+    UBaseType_t uxBands;
+    BaseType_t xInherited;                 /* pdTRUE between inherit and restore. */
+    BaseType_t xFresh;                     /* An inherit since the last restore attempt. */
+    TickType_t xDeadline;                  /* Earliest deadline inherited. */
+    UBaseType_t uxPriority;                /* Priority set by the inherit, 0 if it set none. */
+    uint32_t ulBoosts;                     /* Inherits that raised the priority. */
+    uint32_t ulLate;                       /* Messages queued after their deadline. */
+} IpsaDeadlineInheritor_t;
+
+/*
+ * Fills pxBands, which must hold uxCount entries, from a task set: one band
+ * per task with its relative deadline and priority.  Returns uxCount.
+ */
+UBaseType_t uxIpsaDeadlineBands( const IpsaTask_t * pxTasks,
+                                 size_t uxCount,
+                                 IpsaDeadlineBand_t * pxBands );
+
+/*
+ * Binds pxInheritor to the consumer xTask, whose current priority becomes
+ * its base priority.  Must run before the producers inherit through it.
+ */
+void vIpsaDeadlineInit( IpsaDeadlineInheritor_t * pxInheritor,
+                        TaskHandle_t xTask,
+                        const IpsaDeadlineBand_t * pxBands,
+                        UBaseType_t uxBands );
+
+/*
+ * Called by the producer once a message due by xDeadline is queued.  Raises
+ * the consumer to the priority that meets xDeadline if that is above its
+ * current one.  Several inherits before a restore keep the most urgent.
+ */
+void vIpsaDeadlineInherit( IpsaDeadlineInheritor_t * pxInheritor,
+                           TickType_t xDeadline );
+
+/*
+ * Called by the consumer once it found its queue empty.  Returns the
+ * consumer to its base priority, unless something else changed its
+ * priority since it inherited, and returns pdTRUE.  Returns pdFALSE and
+ * leaves the priority alone if a message was inherited since the last call,
+ * the consumer must then look at its queue again before restoring.
+ */
+BaseType_t xIpsaDeadlineRestore( IpsaDeadlineInheritor_t * pxInheritor );
+
+#endif /* IPSA_DEADLINE_H */
@@ -0,0 +1,180 @@
+/*
+ * Run time selection of the compute kernels, see ipsa_dispatch.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ipsa_dispatch.h"
+#include "ipsa_temp.h"
+#include "ipsa_index.h"
+
+/* Largest input used by the self test. */
+#define dispatchTEST_MAX_COUNT             ( 67U )
+
+/*-----------------------------------------------------------*/
+
+typedef struct IPSA_KERNEL_SET
+{
+    IpsaTempBatchKernel_t pxTempBatch;
+    IpsaRankKernel_t pxRank;
+} IpsaKernelSet_t;
+
+/* Kernels per level.  SSE4.2 has no gather, the batch conversion stays
+ * scalar until AVX2. */
+#if ( ipsaDISPATCH_X86 == 1 )
+    static const IpsaKernelSet_t xKernels[ eIpsaIsaCount ] =
+    {
+        { vIpsaTempCelsiusBatchScalar, uxIpsaKeyRankScalar },
+        { vIpsaTempCelsiusBatchScalar, uxIpsaKeyRankSse42  },
+        { vIpsaTempCelsiusBatchAvx2,   uxIpsaKeyRankAvx2   },
+        { vIpsaTempCelsiusBatchAvx512, uxIpsaKeyRankAvx512 }
+    };
+#else
+    static const IpsaKernelSet_t xKernels[ eIpsaIsaCount ] =
+    {
+        { vIpsaTempCelsiusBatchScalar, uxIpsaKeyRankScalar },
+        { vIpsaTempCelsiusBatchScalar, uxIpsaKeyRankScalar },
+        { vIpsaTempCelsiusBatchScalar, uxIpsaKeyRankScalar },
+        { vIpsaTempCelsiusBatchScalar, uxIpsaKeyRankScalar }
+    };
+#endif
+
+static const char * const pcIsaNames[ eIpsaIsaCount ] =
+{
+    "scalar", "sse4.2", "avx2", "avx512"
+};
+
+IpsaTempBatchKernel_t pxIpsaTempBatchKernel = vIpsaTempCelsiusBatchScalar;
+IpsaRankKernel_t pxIpsaRankKernel = uxIpsaKeyRankScalar;
+
+/*-----------------------------------------------------------*/
+
+eIpsaIsa eIpsaDispatchDetect( void )
+{
+    eIpsaIsa eLevel = eIpsaIsaScalar;
+
+    #if ( ipsaDISPATCH_X86 == 1 )
+    {
+        /* The builtins also check that the operating system saves the wider
+         * register state. */
+        __builtin_cpu_init();
+
+        if( __builtin_cpu_supports( "avx512f" ) )
+        {
+            eLevel = eIpsaIsaAvx512;
+        }
+        else if( __builtin_cpu_supports( "avx2" ) )
+        {
+            eLevel = eIpsaIsaAvx2;
+        }
+        else if( __builtin_cpu_supports( "sse4.2" ) && __builtin_cpu_supports( "popcnt" ) )
+        {
+            eLevel = eIpsaIsaSse42;
+        }
+    }
+    #endif /* ipsaDISPATCH_X86 */
+
+    return eLevel;
+}
+/*-----------------------------------------------------------*/
+
+eIpsaIsa eIpsaDispatchForce( eIpsaIsa eLevel )
+{
+    eIpsaIsa eSupported = eIpsaDispatchDetect();
+
+    if( ( eLevel < eIpsaIsaScalar ) || ( eLevel > eSupported ) )
+    {
+        eLevel = eSupported;
+    }
+
+    pxIpsaTempBatchKernel = xKernels[ eLevel ].pxTempBatch;
+    pxIpsaRankKernel = xKernels[ eLevel ].pxRank;
+
+    return eLevel;
+}
+/*-----------------------------------------------------------*/
+
+eIpsaIsa eIpsaDispatchInit( void )
+{
+    eIpsaIsa eLevel = eIpsaIsaCount, x;
+    const char * pcOverride = getenv( "IPSA_ISA" );
+
+    if( pcOverride != NULL )
+    {
+        for( x = eIpsaIsaScalar; x < eIpsaIsaCount; x++ )
+        {
+            if( strcmp( pcOverride, pcIsaNames[ x ] ) == 0 )
+            {
+                eLevel = x;
+            }
+        }
+    }
+
+    return eIpsaDispatchForce( eLevel );
+}
+/*-----------------------------------------------------------*/
+
+const char * pcIpsaIsaName( eIpsaIsa eLevel )
+{
+    if( ( eLevel < eIpsaIsaScalar ) || ( eLevel >= eIpsaIsaCount ) )
+    {
+        return "unknown";
+    }
+
+    return pcIsaNames[ eLevel ];
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvNextRandom( uint32_t * pulState )
+{
+    *pulState = ( *pulState * 1664525UL ) + 1013904223UL;
+
+    return *pulState >> 8;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulIpsaDispatchSelfTest( void )
+{
+    uint16_t usCodes[ dispatchTEST_MAX_COUNT ];
+    float fExpected[ dispatchTEST_MAX_COUNT ], fActual[ dispatchTEST_MAX_COUNT ];
+    int iKeys[ dispatchTEST_MAX_COUNT ];
+    uint32_t ulState = 0x1234567UL, ulMismatches = 0;
+    eIpsaIsa eSupported = eIpsaDispatchDetect(), eLevel;
+    size_t uxCount, x;
+    int iKey;
+
+    /* Every length up to the largest vector width plus a tail. */
+    for( uxCount = 0; uxCount <= dispatchTEST_MAX_COUNT; uxCount++ )
+    {
+        for( x = 0; x < uxCount; x++ )
+        {
+            usCodes[ x ] = ( uint16_t ) prvNextRandom( &ulState );
+            iKeys[ x ] = ( ( x == 0U ) ? ( int ) -1000 : iKeys[ x - 1U ] ) + ( int ) ( prvNextRandom( &ulState ) % 3U );
+        }
+
+        vIpsaTempCelsiusBatchScalar( usCodes, fExpected, uxCount );
+
+        for( eLevel = eIpsaIsaSse42; eLevel <= eSupported; eLevel++ )
+        {
+            xKernels[ eLevel ].pxTempBatch( usCodes, fActual, uxCount );
+
+            if( ( uxCount > 0U ) && ( memcmp( fExpected, fActual, uxCount * sizeof( float ) ) != 0 ) )
+            {
+                ulMismatches++;
+            }
+
+            /* Keys below, inside and above the table. */
+            for( iKey = -1002; iKey <= ( ( int ) -1000 + ( 2 * ( int ) uxCount ) + 2 ); iKey++ )
+            {
+                if( xKernels[ eLevel ].pxRank( iKeys, uxCount, iKey ) != uxIpsaKeyRankScalar( iKeys, uxCount, iKey ) )
+                {
+                    ulMismatches++;
+                }
+            }
+        }
+    }
+
+    return ulMismatches;
+}
+/*-----------------------------------------------------------*/
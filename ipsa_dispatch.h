@@ -0,0 +1,76 @@
+/*
+ * Run time selection of the compute kernels.
+ *
+ * Every kernel is built in a scalar version and, on x86 with GCC compatible
+ * compilers, in SSE4.2 / AVX2 / AVX-512 versions through target attributes,
+ * so a single binary runs on any host.  eIpsaDispatchInit() detects the CPU
+ * features once and binds the kernel pointers to the best versions.  The
+ * IPSA_ISA environment variable (scalar, sse4.2, avx2, avx512) or
+ * eIpsaDispatchForce() caps the level, which helps comparing variants.
+ */
+
+#ifndef IPSA_DISPATCH_H
+#define IPSA_DISPATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* 1 when the SSE4.2 / AVX2 / AVX-512 kernel variants are built. */
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+    #define ipsaDISPATCH_X86               1
+#else
+    #define ipsaDISPATCH_X86               0
+#endif
+
+typedef enum
+{
+    eIpsaIsaScalar = 0,
+    eIpsaIsaSse42,
+    eIpsaIsaAvx2,
+    eIpsaIsaAvx512,
+    eIpsaIsaCount
+} eIpsaIsa;
+
+/* Batch Fahrenheit code to Celsius conversion, see ipsa_temp.h. */
+typedef void (* IpsaTempBatchKernel_t)( const uint16_t * pusCodes,
+                                        float * pfCelsius,
+                                        size_t uxCount );
+
+/* Number of keys below iKey in a sorted array, i.e. its lower bound. */
+typedef size_t (* IpsaRankKernel_t)( const int * piKeys,
+                                     size_t uxCount,
+                                     int iKey );
+
+/* Bound kernels, the scalar versions until eIpsaDispatchInit() runs. */
+extern IpsaTempBatchKernel_t pxIpsaTempBatchKernel;
+extern IpsaRankKernel_t pxIpsaRankKernel;
+
+/*
+ * Detects the CPU features and binds the kernels, honouring IPSA_ISA.
+ * Returns the level in use.  Safe to call more than once.
+ */
+eIpsaIsa eIpsaDispatchInit( void );
+
+/*
+ * Highest level supported by the CPU and the operating system.
+ */
+eIpsaIsa eIpsaDispatchDetect( void );
+
+/*
+ * Rebinds the kernels for at most eLevel (clamped to what the CPU supports).
+ * Returns the level in use.
+ */
+eIpsaIsa eIpsaDispatchForce( eIpsaIsa eLevel );
+
+/*
+ * Name of a level, as accepted by IPSA_ISA.
+ */
+const char * pcIpsaIsaName( eIpsaIsa eLevel );
+
+/*
+ * Runs every variant the CPU supports on the same inputs and compares the
+ * results with the scalar version.  Returns the number of mismatches.
+ */
+uint32_t ulIpsaDispatchSelfTest( void );
+
+#endif /* IPSA_DISPATCH_H */
@@ -0,0 +1,92 @@
+/*
+ * Tick count drift monitoring and correction, see ipsa_drift.h.
+ */
+
+#include <time.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "ipsa_drift.h"
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNow( void );
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNow( void )
+{
+    struct timespec xTime;
+
+    clock_gettime( CLOCK_MONOTONIC, &xTime );
+
+    return ( ( uint64_t ) xTime.tv_sec * 1000000000ULL ) + ( uint64_t ) xTime.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaDriftInit( IpsaDrift_t * pxDrift )
+{
+    pxDrift->xStarted = pdFALSE;
+    pxDrift->ullStartNs = 0;
+    pxDrift->xStartTick = 0;
+    pxDrift->lLag = 0;
+    pxDrift->lMaxLag = 0;
+    pxDrift->lPpm = 0;
+    pxDrift->ulCorrections = 0;
+    pxDrift->ulTicksAdded = 0;
+}
+/*-----------------------------------------------------------*/
+
+int32_t lIpsaDriftSample( IpsaDrift_t * pxDrift,
+                          BaseType_t xCorrect )
+{
+    uint64_t ullNow, ullExpected;
+    TickType_t xTicks;
+    int64_t llCounted;
+
+    /* Read both clocks as close together as possible. */
+    taskENTER_CRITICAL();
+    {
+        xTicks = xTaskGetTickCount();
+        ullNow = prvNow();
+    }
+    taskEXIT_CRITICAL();
+
+    if( pxDrift->xStarted == pdFALSE )
+    {
+        pxDrift->xStarted = pdTRUE;
+        pxDrift->ullStartNs = ullNow;
+        pxDrift->xStartTick = xTicks;
+        return 0;
+    }
+
+    ullExpected = ( ( ullNow - pxDrift->ullStartNs ) * configTICK_RATE_HZ ) / 1000000000ULL;
+
+    /* Corrections are counted ticks too, take them out of the rate. */
+    llCounted = ( int64_t ) ( TickType_t ) ( xTicks - pxDrift->xStartTick );
+    pxDrift->lLag = ( int32_t ) ( ( int64_t ) ullExpected - llCounted );
+
+    if( ullExpected != 0U )
+    {
+        pxDrift->lPpm = ( int32_t ) ( ( ( ( int64_t ) ullExpected - ( llCounted - pxDrift->ulTicksAdded ) ) * 1000000LL ) /
+                                      ( int64_t ) ullExpected );
+    }
+
+    if( pxDrift->lLag > pxDrift->lMaxLag )
+    {
+        pxDrift->lMaxLag = pxDrift->lLag;
+    }
+
+    if( ( xCorrect != pdFALSE ) && ( pxDrift->lLag >= ipsaDRIFT_THRESHOLD ) )
+    {
+        ( void ) xTaskCatchUpTicks( ( TickType_t ) pxDrift->lLag );
+        pxDrift->ulCorrections++;
+        pxDrift->ulTicksAdded += ( uint32_t ) pxDrift->lLag;
+    }
+
+    return pxDrift->lLag;
+}
+/*-----------------------------------------------------------*/
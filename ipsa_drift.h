@@ -0,0 +1,51 @@
+/*
+ * Tick count drift against CLOCK_MONOTONIC.
+ *
+ * The Linux port drives the tick from a host timer signal.  When the host
+ * is loaded the signals arrive late and some are merged, so the tick count
+ * falls behind real time and every vTaskDelayUntil() period stretches with
+ * it.  xIpsaDriftSample() compares the ticks counted since the first sample
+ * with the ticks that should have elapsed according to CLOCK_MONOTONIC and
+ * keeps the lag and the drift rate in parts per million.  With correction
+ * enabled a lag of ipsaDRIFT_THRESHOLD ticks or more is made up with
+ * xTaskCatchUpTicks(), which releases the delayed tasks as if the missed
+ * ticks had happened, so periodic tasks keep their real world rate.  A tick
+ * count running ahead cannot be slowed down and is only reported.
+ *
+ * Call xIpsaDriftSample() periodically from a task or a timer callback,
+ * never from an interrupt or with the scheduler suspended.
+ */
+
+#ifndef IPSA_DRIFT_H
+#define IPSA_DRIFT_H
+
+#include "FreeRTOS.h"
+
+/* Smallest lag, in ticks, that a correction makes up. */
+#ifndef ipsaDRIFT_THRESHOLD
+    #define ipsaDRIFT_THRESHOLD            ( 2 )
+#endif
+
+typedef struct IPSA_DRIFT
+{
+    BaseType_t xStarted;
+    uint64_t ullStartNs;
+    TickType_t xStartTick;
+    int32_t lLag;                   /* Ticks behind real time at the last sample, negative if ahead. */
+    int32_t lMaxLag;
+    int32_t lPpm;                   /* Lag over elapsed time, before correction. */
+    uint32_t ulCorrections;
+    uint32_t ulTicksAdded;          /* Ticks made up by the corrections. */
+} IpsaDrift_t;
+
+void vIpsaDriftInit( IpsaDrift_t * pxDrift );
+
+/*
+ * Measures the lag, the first call only takes the reference.  If xCorrect
+ * is pdTRUE, makes up a lag of ipsaDRIFT_THRESHOLD ticks or more.  Returns
+ * the lag in ticks measured before any correction.
+ */
+int32_t lIpsaDriftSample( IpsaDrift_t * pxDrift,
+                          BaseType_t xCorrect );
+
+#endif /* IPSA_DRIFT_H */
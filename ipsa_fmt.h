@@ -0,0 +1,109 @@
+/*
+ * Allocation free number formatting for the task output.
+ *
+ * printf() parses its format string, consults the locale and takes the
+ * stdio lock for every message.  The functions below write straight into a
+ * caller supplied buffer instead: integers two digits at a time, floating
+ * point values as the shortest decimal that reads back to the same value
+ * (the Ryu algorithm, table driven, no big integers).  None of them
+ * allocate, lock or touch global state, so they may be called from any task.
+ *
+ * Every function writes at most uxSize bytes including the terminating NUL,
+ * truncating if needed, and returns the length of the complete text, as
+ * snprintf() does.  A return value >= uxSize therefore means truncation.
+ */
+
+#ifndef IPSA_FMT_H
+#define IPSA_FMT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Longest text produced for a single number, without the NUL. */
+#define ipsaFMT_MAX_NUMBER                 ( 32 )
+
+size_t uxIpsaFmtUint64( char * pcBuffer,
+                        size_t uxSize,
+                        uint64_t ullValue );
+
+size_t uxIpsaFmtInt64( char * pcBuffer,
+                       size_t uxSize,
+                       int64_t llValue );
+
+/*
+ * Shortest round trip representation, in fixed notation when the decimal
+ * point falls within a few digits of the value ("23.5", "0.001", "1200")
+ * and in scientific notation otherwise ("1.5e+300").  Also "nan", "inf",
+ * "-inf".
+ */
+size_t uxIpsaFmtDouble( char * pcBuffer,
+                        size_t uxSize,
+                        double dValue );
+
+/*
+ * As uxIpsaFmtDouble() but shortest for single precision, so a value that
+ * came from a float prints as "37.77778" rather than "37.77777862548828".
+ */
+size_t uxIpsaFmtFloat( char * pcBuffer,
+                       size_t uxSize,
+                       float fValue );
+
+/*
+ * ulDecimals digits after the point, at most 17, like "%.*f": the exact
+ * binary value is rounded, ties to even, so 0.125 gives "0.12" with two
+ * decimals, and the sign of -0.0 is kept.  Values of 2^64 and more fall
+ * back to uxIpsaFmtDouble().
+ */
+size_t uxIpsaFmtFixed( char * pcBuffer,
+                       size_t uxSize,
+                       double dValue,
+                       uint32_t ulDecimals );
+
+/*
+ * Template formatting.  Each "{}" in pcTemplate is replaced by the next
+ * argument, "{{" and "}}" produce literal braces.  Arguments are built with
+ * the ipsaFMT_xxx() macros, for example:
+ *
+ *     IpsaFmtArg_t xArgs[] = { ipsaFMT_STR( "Task2" ), ipsaFMT_FLOAT( fCelsius ) };
+ *     uxIpsaFmt( cLine, sizeof( cLine ), "{}: {} C\n", xArgs, 2 );
+ *
+ * Placeholders without a matching argument are copied through unchanged.
+ */
+typedef enum
+{
+    eIpsaFmtInt,
+    eIpsaFmtUint,
+    eIpsaFmtDouble,
+    eIpsaFmtFloat,
+    eIpsaFmtFixed,
+    eIpsaFmtString
+} eIpsaFmtType;
+
+typedef struct IPSA_FMT_ARG
+{
+    eIpsaFmtType eType;
+    uint32_t ulDecimals;    /* eIpsaFmtFixed only. */
+    union
+    {
+        int64_t llInt;
+        uint64_t ullUint;
+        double dDouble;
+        float fFloat;
+        const char * pcString;
+    } u;
+} IpsaFmtArg_t;
+
+#define ipsaFMT_INT( x )                   { eIpsaFmtInt, 0, { .llInt = ( int64_t ) ( x ) } }
+#define ipsaFMT_UINT( x )                  { eIpsaFmtUint, 0, { .ullUint = ( uint64_t ) ( x ) } }
+#define ipsaFMT_DOUBLE( x )                { eIpsaFmtDouble, 0, { .dDouble = ( double ) ( x ) } }
+#define ipsaFMT_FLOAT( x )                 { eIpsaFmtFloat, 0, { .fFloat = ( float ) ( x ) } }
+#define ipsaFMT_FIXED( x, decimals )       { eIpsaFmtFixed, ( decimals ), { .dDouble = ( double ) ( x ) } }
+#define ipsaFMT_STR( s )                   { eIpsaFmtString, 0, { .pcString = ( s ) } }
+
+size_t uxIpsaFmt( char * pcBuffer,
+                  size_t uxSize,
+                  const char * pcTemplate,
+                  const IpsaFmtArg_t * pxArgs,
+                  size_t uxArgs );
+
+#endif /* IPSA_FMT_H */
@@ -0,0 +1,144 @@
+/*
+ * Host side tool that picks the harmonic period set closest to the periods
+ * configured in ipsa_sched.c.
+ *
+ * Build and run on the host (no FreeRTOS needed):
+ *
+ *   gcc -O2 -o ipsa_harmonic_tool ipsa_harmonic_tool.c ipsa_analysis.c -lm
+ *   ./ipsa_harmonic_tool [Name:min:nominal:max[:wcet] ...]
+ *
+ * Without arguments the current Task1..Task4 periods of ipsa_periods.h are
+ * used, each allowed to move by 25%.  The tool prints the old and new
+ * hyperperiod, the rate monotonic utilisation bound of both sets and the
+ * TASKn_PERIOD_MS lines to paste into ipsa_periods.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ipsa_analysis.h"
+#include "ipsa_periods.h"
+
+/* Each period of ipsa_periods.h may move by 25% either way. */
+#define DEFAULT_TASK( pcTask, ulNominal )                                           \
+    {                                                                               \
+        .pcName = ( pcTask ), .ulPeriodMin = ( ulNominal ) - ( ulNominal ) / 4UL, \
+        .ulPeriod = ( ulNominal ), .ulPeriodMax = ( ulNominal ) + ( ulNominal ) / 4UL \
+    }
+
+static IpsaTask_t xDefaultTasks[] =
+{
+    DEFAULT_TASK( "TASK1", TASK1_PERIOD_MS ),
+    DEFAULT_TASK( "TASK2", TASK2_PERIOD_MS ),
+    DEFAULT_TASK( "TASK3", TASK3_PERIOD_MS ),
+    DEFAULT_TASK( "TASK4", TASK4_PERIOD_MS )
+};
+
+static char cNames[ ipsaMAX_TASKS ][ 32 ];
+
+/*-----------------------------------------------------------*/
+
+static int prvParseTask( char * pcArg,
+                         size_t uxIndex,
+                         IpsaTask_t * pxTask )
+{
+    char * pcField[ 5 ] = { NULL };
+    size_t uxFields = 0;
+    char * pcToken;
+
+    for( pcToken = strtok( pcArg, ":" ); ( pcToken != NULL ) && ( uxFields < 5U ); pcToken = strtok( NULL, ":" ) )
+    {
+        pcField[ uxFields++ ] = pcToken;
+    }
+
+    if( uxFields < 4U )
+    {
+        return 0;
+    }
+
+    snprintf( cNames[ uxIndex ], sizeof( cNames[ uxIndex ] ), "%s", pcField[ 0 ] );
+    pxTask->pcName = cNames[ uxIndex ];
+    pxTask->ulPeriodMin = ( uint32_t ) strtoul( pcField[ 1 ], NULL, 10 );
+    pxTask->ulPeriod = ( uint32_t ) strtoul( pcField[ 2 ], NULL, 10 );
+    pxTask->ulPeriodMax = ( uint32_t ) strtoul( pcField[ 3 ], NULL, 10 );
+    pxTask->ulWcet = ( uxFields == 5U ) ? ( uint32_t ) strtoul( pcField[ 4 ], NULL, 10 ) : 0UL;
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    IpsaTask_t xTasks[ ipsaMAX_TASKS ];
+    uint32_t ulNominal[ ipsaMAX_TASKS ];
+    IpsaHarmonicResult_t xResult;
+    size_t uxCount, x;
+    int xHaveWcet = 0;
+
+    if( argc > 1 )
+    {
+        uxCount = ( size_t ) ( argc - 1 );
+
+        if( uxCount > ipsaMAX_TASKS )
+        {
+            fprintf( stderr, "At most %d tasks are supported\n", ipsaMAX_TASKS );
+            return 1;
+        }
+
+        for( x = 0; x < uxCount; x++ )
+        {
+            if( prvParseTask( argv[ x + 1U ], x, &xTasks[ x ] ) == 0 )
+            {
+                fprintf( stderr, "Bad task '%s', expected Name:min:nominal:max[:wcet]\n", argv[ x + 1U ] );
+                return 1;
+            }
+        }
+    }
+    else
+    {
+        uxCount = sizeof( xDefaultTasks ) / sizeof( xDefaultTasks[ 0 ] );
+        memcpy( xTasks, xDefaultTasks, sizeof( xDefaultTasks ) );
+    }
+
+    for( x = 0; x < uxCount; x++ )
+    {
+        ulNominal[ x ] = xTasks[ x ].ulPeriod;
+        xHaveWcet |= ( xTasks[ x ].ulWcet != 0UL );
+    }
+
+    printf( "Nominal periods : %s, hyperperiod %llu ms, RM bound %.1f%%\n",
+            xIpsaIsHarmonic( ulNominal, uxCount ) ? "harmonic" : "not harmonic",
+            ( unsigned long long ) ullIpsaHyperperiod( ulNominal, uxCount ),
+            100.0 * ( xIpsaIsHarmonic( ulNominal, uxCount ) ? 1.0 : dIpsaLiuLaylandBound( uxCount ) ) );
+
+    if( xIpsaHarmonicAssign( xTasks, uxCount, &xResult ) == 0 )
+    {
+        printf( "No harmonic period set fits the given ranges.\n" );
+        return 2;
+    }
+
+    printf( "Harmonic periods: hyperperiod %llu ms, RM bound 100.0%%, total deviation %.1f%%\n",
+            ( unsigned long long ) xResult.ullHyperperiod, 100.0 * xResult.dCost );
+
+    if( xHaveWcet != 0 )
+    {
+        printf( "Utilisation     : %.1f%% -> %.1f%%\n",
+                100.0 * dIpsaUtilisation( xTasks, ulNominal, uxCount ),
+                100.0 * dIpsaUtilisation( xTasks, xResult.ulPeriods, uxCount ) );
+    }
+
+    printf( "\n" );
+
+    for( x = 0; x < uxCount; x++ )
+    {
+        printf( "#define %s_PERIOD_MS                    ( %luUL )    /* was %lu */\n",
+                xTasks[ x ].pcName,
+                ( unsigned long ) xResult.ulPeriods[ x ],
+                ( unsigned long ) ulNominal[ x ] );
+    }
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,397 @@
+/*
+ * Two level hierarchical scheduling of task groups, see ipsa_hsched.h.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+/* Local includes. */
+#include "ipsa_hsched.h"
+
+/*-----------------------------------------------------------*/
+
+/* Registered groups. */
+static IpsaGroup_t * pxGroups[ ipsaGROUP_MAX_GROUPS ];
+static UBaseType_t uxGroupCount = 0;
+
+/* Top level bandwidth already admitted, in per mille. */
+static uint32_t ulAdmittedBandwidth = 0;
+
+/* Set while a re-rank is pending in the timer daemon. */
+static volatile BaseType_t xRerankPending = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Recomputes the priority of every member of every group from the top level
+ * EDF order and each group's local policy.
+ */
+static void prvRerank( void * pvParameter1,
+                       uint32_t ulParameter2 );
+
+/*
+ * Position of a member inside its group's band, 0 being the least urgent.
+ */
+static UBaseType_t prvLocalRank( const IpsaGroup_t * pxGroup,
+                                 UBaseType_t uxMember );
+
+/*
+ * Registers the release of a job of pxMember at tick xRelease.  Must be
+ * called with interrupts masked or from the tick hook.
+ */
+static void prvRelease( IpsaGroupMember_t * pxMember,
+                        TickType_t xRelease );
+
+/* Returns pdTRUE if tick a is before tick b, taking wrap around into account. */
+static BaseType_t prvBefore( TickType_t a,
+                             TickType_t b );
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvBefore( TickType_t a,
+                             TickType_t b )
+{
+    return ( ( TickType_t ) ( a - b ) > ( portMAX_DELAY / 2U ) ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaGroupCreate( IpsaGroup_t * pxGroup,
+                             const char * pcName,
+                             int xPolicy,
+                             TickType_t xBudget,
+                             TickType_t xPeriod )
+{
+    uint32_t ulBandwidth;
+    BaseType_t xReturn = pdFAIL;
+
+    configASSERT( ( xBudget > 0 ) && ( xBudget <= xPeriod ) );
+
+    ulBandwidth = ( uint32_t ) ( ( ( uint64_t ) xBudget * 1000U + xPeriod - 1U ) / xPeriod );
+
+    taskENTER_CRITICAL();
+    {
+        if( ( uxGroupCount < ipsaGROUP_MAX_GROUPS ) && ( ( ulAdmittedBandwidth + ulBandwidth ) <= 1000U ) )
+        {
+            pxGroup->pcName = pcName;
+            pxGroup->xPolicy = xPolicy;
+            pxGroup->xBudget = xBudget;
+            pxGroup->xPeriod = xPeriod;
+            pxGroup->xRemaining = xBudget;
+            pxGroup->xPeriodEnd = xTaskGetTickCount() + xPeriod;
+            pxGroup->uxMembers = 0;
+            pxGroup->ulDepletions = 0;
+
+            pxGroups[ uxGroupCount++ ] = pxGroup;
+            ulAdmittedBandwidth += ulBandwidth;
+            xReturn = pdPASS;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaGroupAddTask( IpsaGroup_t * pxGroup,
+                              TaskHandle_t xTask,
+                              UBaseType_t uxLocalPriority,
+                              TickType_t xRelativeDeadline )
+{
+    IpsaGroupMember_t * pxMember;
+    BaseType_t xMember = -1;
+
+    taskENTER_CRITICAL();
+    {
+        if( pxGroup->uxMembers < ipsaGROUP_MAX_MEMBERS )
+        {
+            xMember = ( BaseType_t ) pxGroup->uxMembers++;
+            pxMember = &pxGroup->xMembers[ xMember ];
+            pxMember->xTask = xTask;
+            pxMember->uxLocalPriority = uxLocalPriority;
+            pxMember->xRelativeDeadline = xRelativeDeadline;
+            pxMember->xRelease = xTaskGetTickCount();
+            pxMember->xDeadline = pxMember->xRelease + xRelativeDeadline;
+            pxMember->xPeriod = 0;
+            pxMember->xNextRelease = 0;
+            pxMember->uxPending = 0;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( xMember >= 0 )
+    {
+        prvRerank( NULL, 0 );
+    }
+
+    return xMember;
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaGroupPeriodicReleases( IpsaGroup_t * pxGroup,
+                                 BaseType_t xMember,
+                                 TickType_t xFirstRelease,
+                                 TickType_t xPeriod )
+{
+    configASSERT( xPeriod > 0 );
+
+    taskENTER_CRITICAL();
+    {
+        pxGroup->xMembers[ xMember ].xNextRelease = xFirstRelease;
+        pxGroup->xMembers[ xMember ].xPeriod = xPeriod;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static void prvRelease( IpsaGroupMember_t * pxMember,
+                        TickType_t xRelease )
+{
+    /* A job released while the previous one still runs takes its deadline
+     * when that one completes. */
+    if( pxMember->uxPending++ == 0U )
+    {
+        pxMember->xRelease = xRelease;
+        pxMember->xDeadline = xRelease + pxMember->xRelativeDeadline;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaGroupJobBegin( IpsaGroup_t * pxGroup,
+                         BaseType_t xMember )
+{
+    taskENTER_CRITICAL();
+    {
+        prvRelease( &pxGroup->xMembers[ xMember ], xTaskGetTickCount() );
+    }
+    taskEXIT_CRITICAL();
+
+    prvRerank( NULL, 0 );
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaGroupJobEnd( IpsaGroup_t * pxGroup,
+                       BaseType_t xMember )
+{
+    IpsaGroupMember_t * pxMember = &pxGroup->xMembers[ xMember ];
+
+    taskENTER_CRITICAL();
+    {
+        if( pxMember->uxPending > 0U )
+        {
+            pxMember->uxPending--;
+        }
+
+        /* The next pending job was released one period after this one. */
+        if( ( pxMember->uxPending > 0U ) && ( pxMember->xPeriod > 0U ) )
+        {
+            pxMember->xRelease += pxMember->xPeriod;
+            pxMember->xDeadline = pxMember->xRelease + pxMember->xRelativeDeadline;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    prvRerank( NULL, 0 );
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaGroupInheritDeadline( IpsaGroup_t * pxGroup,
+                                BaseType_t xMember,
+                                TickType_t xDeadline )
+{
+    IpsaGroupMember_t * pxMember = &pxGroup->xMembers[ xMember ];
+    BaseType_t xEarlier = pdFALSE;
+
+    taskENTER_CRITICAL();
+    {
+        if( ( pxMember->uxPending > 0U ) && ( prvBefore( xDeadline, pxMember->xDeadline ) != pdFALSE ) )
+        {
+            pxMember->xDeadline = xDeadline;
+            xEarlier = pdTRUE;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( ( xEarlier != pdFALSE ) && ( pxGroup->xPolicy == ipsaLOCAL_EDF ) )
+    {
+        prvRerank( NULL, 0 );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvLocalRank( const IpsaGroup_t * pxGroup,
+                                 UBaseType_t uxMember )
+{
+    const IpsaGroupMember_t * pxMember = &pxGroup->xMembers[ uxMember ];
+    const IpsaGroupMember_t * pxOther;
+    UBaseType_t uxRank = 0, x;
+
+    for( x = 0; x < pxGroup->uxMembers; x++ )
+    {
+        pxOther = &pxGroup->xMembers[ x ];
+
+        if( x == uxMember )
+        {
+            continue;
+        }
+
+        if( pxGroup->xPolicy == ipsaLOCAL_EDF )
+        {
+            /* Idle members and later deadlines rank below; ties are broken
+             * by index so every member gets a distinct level. */
+            if( ( pxOther->uxPending == 0U ) ||
+                ( prvBefore( pxMember->xDeadline, pxOther->xDeadline ) != pdFALSE ) ||
+                ( ( pxMember->xDeadline == pxOther->xDeadline ) && ( x > uxMember ) ) )
+            {
+                uxRank++;
+            }
+        }
+        else
+        {
+            if( ( pxOther->uxLocalPriority < pxMember->uxLocalPriority ) ||
+                ( ( pxOther->uxLocalPriority == pxMember->uxLocalPriority ) && ( x > uxMember ) ) )
+            {
+                uxRank++;
+            }
+        }
+    }
+
+    return uxRank;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRerank( void * pvParameter1,
+                       uint32_t ulParameter2 )
+{
+    TaskHandle_t xTasks[ ipsaGROUP_MAX_GROUPS * ipsaGROUP_MAX_MEMBERS ];
+    UBaseType_t uxPriorities[ ipsaGROUP_MAX_GROUPS * ipsaGROUP_MAX_MEMBERS ];
+    UBaseType_t uxTasks = 0, uxRunning, x, y;
+    IpsaGroup_t * pxGroup;
+    BaseType_t xHasWork;
+
+    ( void ) pvParameter1;
+    ( void ) ulParameter2;
+
+    taskENTER_CRITICAL();
+    {
+        xRerankPending = pdFALSE;
+        uxRunning = uxGroupCount;
+
+        /* Top level EDF: earliest period end among groups that have both
+         * budget and a pending job. */
+        for( x = 0; x < uxGroupCount; x++ )
+        {
+            pxGroup = pxGroups[ x ];
+            xHasWork = pdFALSE;
+
+            for( y = 0; y < pxGroup->uxMembers; y++ )
+            {
+                if( pxGroup->xMembers[ y ].uxPending > 0U )
+                {
+                    xHasWork = pdTRUE;
+                }
+            }
+
+            if( ( xHasWork != pdFALSE ) && ( pxGroup->xRemaining > 0 ) &&
+                ( ( uxRunning == uxGroupCount ) ||
+                  ( prvBefore( pxGroup->xPeriodEnd, pxGroups[ uxRunning ]->xPeriodEnd ) != pdFALSE ) ) )
+            {
+                uxRunning = x;
+            }
+        }
+
+        for( x = 0; x < uxGroupCount; x++ )
+        {
+            pxGroup = pxGroups[ x ];
+
+            for( y = 0; y < pxGroup->uxMembers; y++ )
+            {
+                xTasks[ uxTasks ] = pxGroup->xMembers[ y ].xTask;
+
+                if( pxGroup->xRemaining == 0 )
+                {
+                    uxPriorities[ uxTasks ] = ipsaGROUP_DEPLETED_PRIORITY;
+                }
+                else if( x == uxRunning )
+                {
+                    uxPriorities[ uxTasks ] = ipsaGROUP_RUN_BASE_PRIORITY + prvLocalRank( pxGroup, y );
+                }
+                else
+                {
+                    uxPriorities[ uxTasks ] = ipsaGROUP_WAIT_BASE_PRIORITY + prvLocalRank( pxGroup, y );
+                }
+
+                uxTasks++;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    for( x = 0; x < uxTasks; x++ )
+    {
+        if( uxTaskPriorityGet( xTasks[ x ] ) != uxPriorities[ x ] )
+        {
+            vTaskPrioritySet( xTasks[ x ], uxPriorities[ x ] );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaGroupTickHook( void )
+{
+    TaskHandle_t xCurrent = xTaskGetCurrentTaskHandle();
+    TickType_t xNow = xTaskGetTickCountFromISR();
+    BaseType_t xRerank = pdFALSE;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    IpsaGroup_t * pxGroup;
+    IpsaGroupMember_t * pxMember;
+    UBaseType_t x, y;
+
+    for( x = 0; x < uxGroupCount; x++ )
+    {
+        pxGroup = pxGroups[ x ];
+
+        /* Periodic replenishment, also moves the top level deadline. */
+        while( prvBefore( xNow, pxGroup->xPeriodEnd ) == pdFALSE )
+        {
+            pxGroup->xPeriodEnd += pxGroup->xPeriod;
+            pxGroup->xRemaining = pxGroup->xBudget;
+            xRerank = pdTRUE;
+        }
+
+        for( y = 0; y < pxGroup->uxMembers; y++ )
+        {
+            pxMember = &pxGroup->xMembers[ y ];
+
+            if( ( pxMember->xPeriod > 0U ) && ( prvBefore( xNow, pxMember->xNextRelease ) == pdFALSE ) )
+            {
+                prvRelease( pxMember, pxMember->xNextRelease );
+                pxMember->xNextRelease += pxMember->xPeriod;
+                xRerank = pdTRUE;
+            }
+
+            if( ( pxMember->xTask == xCurrent ) && ( pxGroup->xRemaining > 0 ) )
+            {
+                pxGroup->xRemaining--;
+
+                if( pxGroup->xRemaining == 0 )
+                {
+                    pxGroup->ulDepletions++;
+                    xRerank = pdTRUE;
+                }
+            }
+        }
+    }
+
+    if( ( xRerank != pdFALSE ) && ( xRerankPending == pdFALSE ) )
+    {
+        if( xTimerPendFunctionCallFromISR( prvRerank, NULL, 0, &xHigherPriorityTaskWoken ) == pdPASS )
+        {
+            xRerankPending = pdTRUE;
+        }
+
+        portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+    }
+}
+/*-----------------------------------------------------------*/
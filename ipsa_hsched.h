@@ -0,0 +1,134 @@
+/*
+ * Two level hierarchical scheduling of task groups.
+ *
+ * Every group is a periodic server receiving a budget every period.  At the
+ * top level the groups are scheduled EDF on the end of their current period:
+ * the group with the earliest period end that still has budget and work
+ * occupies the run band of priorities, the other groups with budget occupy
+ * the wait band, and groups that used up their budget drop to
+ * ipsaGROUP_DEPLETED_PRIORITY until their next period.  Inside its band each
+ * group orders its own tasks with its local policy, ipsaLOCAL_FP (static
+ * local priorities) or ipsaLOCAL_EDF (absolute job deadlines).
+ *
+ * Job releases are signalled with vIpsaGroupJobBegin() or, for a periodic
+ * member, registered by the tick hook at each release after
+ * vIpsaGroupPeriodicReleases(), so a member waiting in a low band counts
+ * for the top level EDF order from its release on rather than from the time
+ * it is dispatched.
+ *
+ * A group is admitted on bandwidth alone, so groups validated in isolation
+ * with xIpsaGroupIsSchedulable() can be added without analysing the rest of
+ * the system.
+ *
+ * Requirements: vIpsaGroupTickHook() must be called from
+ * vApplicationTickHook() and INCLUDE_xTimerPendFunctionCall must be 1.
+ * configMAX_PRIORITIES must leave room for both bands below the timer task.
+ */
+
+#ifndef IPSA_HSCHED_H
+#define IPSA_HSCHED_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ipsa_analysis.h"
+
+#ifndef ipsaGROUP_MAX_GROUPS
+    #define ipsaGROUP_MAX_GROUPS           ( 4 )
+#endif
+
+/* Tasks per group, also the width of each priority band. */
+#ifndef ipsaGROUP_MAX_MEMBERS
+    #define ipsaGROUP_MAX_MEMBERS          ( 2 )
+#endif
+
+#ifndef ipsaGROUP_WAIT_BASE_PRIORITY
+    #define ipsaGROUP_WAIT_BASE_PRIORITY   ( tskIDLE_PRIORITY + 1 )
+#endif
+
+#ifndef ipsaGROUP_RUN_BASE_PRIORITY
+    #define ipsaGROUP_RUN_BASE_PRIORITY    ( ipsaGROUP_WAIT_BASE_PRIORITY + ipsaGROUP_MAX_MEMBERS )
+#endif
+
+#ifndef ipsaGROUP_DEPLETED_PRIORITY
+    #define ipsaGROUP_DEPLETED_PRIORITY    ( tskIDLE_PRIORITY )
+#endif
+
+typedef struct IPSA_GROUP_MEMBER
+{
+    TaskHandle_t xTask;
+    UBaseType_t uxLocalPriority;   /* ipsaLOCAL_FP: higher is more urgent. */
+    TickType_t xRelativeDeadline;  /* ipsaLOCAL_EDF: deadline after job release. */
+    TickType_t xRelease;           /* Release of the current job. */
+    TickType_t xDeadline;          /* Absolute deadline of the current job. */
+    TickType_t xPeriod;            /* Release period, 0 if not periodic. */
+    TickType_t xNextRelease;       /* Next periodic release. */
+    UBaseType_t uxPending;         /* Jobs released and not completed yet. */
+} IpsaGroupMember_t;
+
+typedef struct IPSA_GROUP
+{
+    const char * pcName;
+    int xPolicy;                   /* ipsaLOCAL_FP or ipsaLOCAL_EDF. */
+    TickType_t xBudget;
+    TickType_t xPeriod;
+    TickType_t xRemaining;         /* Budget left in the current period. */
+    TickType_t xPeriodEnd;         /* End of the current period, the group's top level deadline. */
+    IpsaGroupMember_t xMembers[ ipsaGROUP_MAX_MEMBERS ];
+    UBaseType_t uxMembers;
+    uint32_t ulDepletions;         /* Periods in which the budget ran out. */
+} IpsaGroup_t;
+
+/*
+ * Registers a group served xBudget ticks every xPeriod ticks.  Returns pdFAIL
+ * if the top level bandwidth would exceed 100% or no group slot is left.
+ */
+BaseType_t xIpsaGroupCreate( IpsaGroup_t * pxGroup,
+                             const char * pcName,
+                             int xPolicy,
+                             TickType_t xBudget,
+                             TickType_t xPeriod );
+
+/*
+ * Adds xTask to the group.  Returns the member index used with the job
+ * functions below, or -1 if the group is full.
+ */
+BaseType_t xIpsaGroupAddTask( IpsaGroup_t * pxGroup,
+                              TaskHandle_t xTask,
+                              UBaseType_t uxLocalPriority,
+                              TickType_t xRelativeDeadline );
+
+/*
+ * Has the tick hook release a job of the member every xPeriod ticks, the
+ * first one at tick xFirstRelease.  The member task must be released at the
+ * same ticks and then only calls vIpsaGroupJobEnd().
+ */
+void vIpsaGroupPeriodicReleases( IpsaGroup_t * pxGroup,
+                                 BaseType_t xMember,
+                                 TickType_t xFirstRelease,
+                                 TickType_t xPeriod );
+
+/*
+ * Called by a member task at the start and end of each job.  Members with
+ * periodic releases do not call vIpsaGroupJobBegin().
+ */
+void vIpsaGroupJobBegin( IpsaGroup_t * pxGroup,
+                         BaseType_t xMember );
+void vIpsaGroupJobEnd( IpsaGroup_t * pxGroup,
+                       BaseType_t xMember );
+
+/*
+ * Moves the current job's deadline forward to xDeadline if that is earlier,
+ * for a job handling a message due by then.  Only affects ipsaLOCAL_EDF
+ * groups; the job's own deadline comes back at its next vIpsaGroupJobBegin().
+ */
+void vIpsaGroupInheritDeadline( IpsaGroup_t * pxGroup,
+                                BaseType_t xMember,
+                                TickType_t xDeadline );
+
+/*
+ * Budget accounting and replenishment, call from vApplicationTickHook().
+ */
+void vIpsaGroupTickHook( void );
+
+#endif /* IPSA_HSCHED_H */
@@ -0,0 +1,232 @@
+/*
+ * Learned index over a sorted key table, see ipsa_index.h.
+ */
+
+#include <math.h>
+
+#include "ipsa_index.h"
+
+#if ( ipsaDISPATCH_X86 == 1 )
+    #include <immintrin.h>
+#endif
+
+/*-----------------------------------------------------------*/
+
+int xIpsaLearnedIndexBuild( IpsaLearnedIndex_t * pxIndex,
+                            const int * piKeys,
+                            size_t uxKeys,
+                            uint32_t ulMaxError,
+                            IpsaSegment_t * pxStorage,
+                            size_t uxMaxSegments )
+{
+    double dLow = 0.0, dHigh = HUGE_VAL, dDelta, dLowHere, dHighHere;
+    double dError = ( double ) ulMaxError;
+    size_t uxSegments = 0, uxStart = 0, x;
+
+    pxIndex->piKeys = piKeys;
+    pxIndex->uxKeys = uxKeys;
+    pxIndex->pxSegments = pxStorage;
+    pxIndex->uxSegments = 0;
+    pxIndex->ulMaxError = ulMaxError;
+
+    if( uxKeys == 0U )
+    {
+        return 1;
+    }
+
+    /* Shrinking cone: every point narrows the range of slopes that keep all
+     * points of the segment within the error bound of the line through its
+     * first point.  A new segment starts when the range becomes empty. */
+    for( x = 0; x <= uxKeys; x++ )
+    {
+        int xClose = ( x == uxKeys );
+
+        if( xClose == 0 )
+        {
+            dDelta = ( double ) piKeys[ x ] - ( double ) piKeys[ uxStart ];
+
+            if( x == uxStart )
+            {
+                continue;
+            }
+
+            if( dDelta <= 0.0 )
+            {
+                /* Duplicate key: same prediction as the first point. */
+                xClose = ( ( double ) ( x - uxStart ) > dError );
+            }
+            else
+            {
+                dLowHere = ( ( double ) ( x - uxStart ) - dError ) / dDelta;
+                dHighHere = ( ( double ) ( x - uxStart ) + dError ) / dDelta;
+
+                if( ( dLowHere > dHigh ) || ( dHighHere < dLow ) )
+                {
+                    xClose = 1;
+                }
+                else
+                {
+                    dLow = ( dLowHere > dLow ) ? dLowHere : dLow;
+                    dHigh = ( dHighHere < dHigh ) ? dHighHere : dHigh;
+                }
+            }
+        }
+
+        if( xClose != 0 )
+        {
+            if( uxSegments == uxMaxSegments )
+            {
+                return 0;
+            }
+
+            pxStorage[ uxSegments ].iFirstKey = piKeys[ uxStart ];
+            pxStorage[ uxSegments ].ulFirstPosition = ( uint32_t ) uxStart;
+            pxStorage[ uxSegments ].dSlope = ( dHigh == HUGE_VAL ) ? dLow : ( ( dLow + dHigh ) / 2.0 );
+            uxSegments++;
+
+            /* The point that broke the cone starts the next segment. */
+            uxStart = x;
+            dLow = 0.0;
+            dHigh = HUGE_VAL;
+        }
+    }
+
+    pxIndex->uxSegments = uxSegments;
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+long lIpsaLearnedIndexFind( const IpsaLearnedIndex_t * pxIndex,
+                            int iKey )
+{
+    const IpsaSegment_t * pxSegment;
+    size_t uxLow = 0, uxHigh, uxMid;
+    double dPosition;
+    long lLeft, lRight, lFound, lLast;
+
+    if( ( pxIndex->uxSegments == 0U ) || ( iKey < pxIndex->pxSegments[ 0 ].iFirstKey ) )
+    {
+        return -1;
+    }
+
+    /* Last segment whose first key is not above iKey. */
+    uxHigh = pxIndex->uxSegments - 1U;
+
+    while( uxLow < uxHigh )
+    {
+        uxMid = uxLow + ( ( uxHigh - uxLow + 1U ) / 2U );
+
+        if( pxIndex->pxSegments[ uxMid ].iFirstKey <= iKey )
+        {
+            uxLow = uxMid;
+        }
+        else
+        {
+            uxHigh = uxMid - 1U;
+        }
+    }
+
+    pxSegment = &pxIndex->pxSegments[ uxLow ];
+    dPosition = ( double ) pxSegment->ulFirstPosition +
+                ( pxSegment->dSlope * ( ( double ) iKey - ( double ) pxSegment->iFirstKey ) );
+
+    /* Last mile search inside the error window, widened by one entry for
+     * rounding and clamped to the table.  The window is small, so counting
+     * the keys below iKey with the vector kernel beats a binary search. */
+    lLast = ( long ) pxIndex->uxKeys - 1;
+    lLeft = ( long ) floor( dPosition ) - ( long ) pxIndex->ulMaxError - 1;
+    lRight = ( long ) ceil( dPosition ) + ( long ) pxIndex->ulMaxError + 1;
+    lLeft = ( lLeft < ( long ) pxSegment->ulFirstPosition ) ? ( long ) pxSegment->ulFirstPosition : lLeft;
+    lRight = ( lRight > lLast ) ? lLast : lRight;
+
+    if( lLeft <= lRight )
+    {
+        lFound = lLeft + ( long ) pxIpsaRankKernel( &pxIndex->piKeys[ lLeft ], ( size_t ) ( lRight - lLeft + 1 ), iKey );
+
+        if( ( lFound <= lRight ) && ( pxIndex->piKeys[ lFound ] == iKey ) )
+        {
+            return lFound;
+        }
+    }
+
+    return -1;
+}
+/*-----------------------------------------------------------*/
+
+size_t uxIpsaKeyRankScalar( const int * piKeys,
+                            size_t uxCount,
+                            int iKey )
+{
+    size_t uxRank = 0, x;
+
+    /* Branch free count, the keys are sorted so this is the lower bound. */
+    for( x = 0; x < uxCount; x++ )
+    {
+        uxRank += ( size_t ) ( piKeys[ x ] < iKey );
+    }
+
+    return uxRank;
+}
+/*-----------------------------------------------------------*/
+
+#if ( ipsaDISPATCH_X86 == 1 )
+
+    __attribute__( ( target( "sse4.2,popcnt" ) ) )
+    size_t uxIpsaKeyRankSse42( const int * piKeys,
+                               size_t uxCount,
+                               int iKey )
+    {
+        const __m128i xKey = _mm_set1_epi32( iKey );
+        size_t uxRank = 0, x = 0;
+
+        for( ; ( x + 4U ) <= uxCount; x += 4U )
+        {
+            __m128i xLess = _mm_cmplt_epi32( _mm_loadu_si128( ( const __m128i * ) &piKeys[ x ] ), xKey );
+
+            uxRank += ( size_t ) __builtin_popcount( ( unsigned ) _mm_movemask_ps( _mm_castsi128_ps( xLess ) ) );
+        }
+
+        return uxRank + uxIpsaKeyRankScalar( &piKeys[ x ], uxCount - x, iKey );
+    }
+/*-----------------------------------------------------------*/
+
+    __attribute__( ( target( "avx2,popcnt" ) ) )
+    size_t uxIpsaKeyRankAvx2( const int * piKeys,
+                              size_t uxCount,
+                              int iKey )
+    {
+        const __m256i xKey = _mm256_set1_epi32( iKey );
+        size_t uxRank = 0, x = 0;
+
+        for( ; ( x + 8U ) <= uxCount; x += 8U )
+        {
+            __m256i xLess = _mm256_cmpgt_epi32( xKey, _mm256_loadu_si256( ( const __m256i * ) &piKeys[ x ] ) );
+
+            uxRank += ( size_t ) __builtin_popcount( ( unsigned ) _mm256_movemask_ps( _mm256_castsi256_ps( xLess ) ) );
+        }
+
+        return uxRank + uxIpsaKeyRankScalar( &piKeys[ x ], uxCount - x, iKey );
+    }
+/*-----------------------------------------------------------*/
+
+    __attribute__( ( target( "avx512f,popcnt" ) ) )
+    size_t uxIpsaKeyRankAvx512( const int * piKeys,
+                                size_t uxCount,
+                                int iKey )
+    {
+        const __m512i xKey = _mm512_set1_epi32( iKey );
+        size_t uxRank = 0, x = 0;
+
+        for( ; ( x + 16U ) <= uxCount; x += 16U )
+        {
+            __mmask16 xLess = _mm512_cmplt_epi32_mask( _mm512_loadu_si512( ( const void * ) &piKeys[ x ] ), xKey );
+
+            uxRank += ( size_t ) __builtin_popcount( ( unsigned ) xLess );
+        }
+
+        return uxRank + uxIpsaKeyRankScalar( &piKeys[ x ], uxCount - x, iKey );
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* ipsaDISPATCH_X86 */
@@ -0,0 +1,72 @@
+/*
+ * Learned index over a sorted key table.
+ *
+ * A piecewise linear model maps a key to its approximate position with an
+ * error of at most ulMaxError entries, the exact position is then found by a
+ * vectorised rank count restricted to that window (see ipsa_dispatch.h).
+ * For large tables with smooth key distributions the model needs a handful
+ * of segments instead of the log2( n ) probes across the whole table of a
+ * plain binary search.
+ */
+
+#ifndef IPSA_INDEX_H
+#define IPSA_INDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ipsa_dispatch.h"
+
+/* One linear piece: position = ulFirstPosition + dSlope * ( key - iFirstKey ). */
+typedef struct IPSA_SEGMENT
+{
+    int iFirstKey;
+    uint32_t ulFirstPosition;
+    double dSlope;
+} IpsaSegment_t;
+
+typedef struct IPSA_LEARNED_INDEX
+{
+    const int * piKeys;            /* Sorted table, owned by the caller. */
+    size_t uxKeys;
+    IpsaSegment_t * pxSegments;    /* Model storage, owned by the caller. */
+    size_t uxSegments;
+    uint32_t ulMaxError;           /* Bound on | predicted - actual | position. */
+} IpsaLearnedIndex_t;
+
+/*
+ * Fits the model over piKeys[ 0 .. uxKeys - 1 ], which must be sorted in
+ * ascending order, using at most uxMaxSegments entries of pxStorage.
+ * Returns 1 on success, 0 if more segments would be needed for ulMaxError.
+ */
+int xIpsaLearnedIndexBuild( IpsaLearnedIndex_t * pxIndex,
+                            const int * piKeys,
+                            size_t uxKeys,
+                            uint32_t ulMaxError,
+                            IpsaSegment_t * pxStorage,
+                            size_t uxMaxSegments );
+
+/*
+ * Position of iKey in the table, or -1 if it is not present.
+ */
+long lIpsaLearnedIndexFind( const IpsaLearnedIndex_t * pxIndex,
+                            int iKey );
+
+/* Lower bound kernel variants, selected by ipsa_dispatch.c. */
+size_t uxIpsaKeyRankScalar( const int * piKeys,
+                            size_t uxCount,
+                            int iKey );
+
+#if ( ipsaDISPATCH_X86 == 1 )
+    size_t uxIpsaKeyRankSse42( const int * piKeys,
+                               size_t uxCount,
+                               int iKey );
+    size_t uxIpsaKeyRankAvx2( const int * piKeys,
+                              size_t uxCount,
+                              int iKey );
+    size_t uxIpsaKeyRankAvx512( const int * piKeys,
+                                size_t uxCount,
+                                int iKey );
+#endif
+
+#endif /* IPSA_INDEX_H */
@@ -0,0 +1,299 @@
+/*
+ * Wake up jitter measurement, see ipsa_jitter.h.
+ */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "ipsa_jitter.h"
+
+/* What each probe thread is given. */
+typedef struct JITTER_WORKER
+{
+    IpsaJitterProbe_t * pxProbe;
+    UBaseType_t uxCpu;
+} JitterWorker_t;
+
+static JitterWorker_t xWorkers[ ipsaJITTER_MAX_CPUS ];
+
+/* Start times of the latest ticks, by tick number modulo the history. */
+static uint64_t ullTickTimes[ ipsaJITTER_TICK_HISTORY ];
+static TickType_t xTickNumbers[ ipsaJITTER_TICK_HISTORY ];
+static TickType_t xLatestTick;
+static uint64_t ullLatestTickTime = 0;
+
+/*-----------------------------------------------------------*/
+
+static void * prvProbeThread( void * pvParameter );
+
+/*
+ * Creates a probe thread for xWorkers[ uxCpu ], SCHED_FIFO if xRealTime is
+ * pdTRUE.  Returns 0 or an errno value.
+ */
+static int prvCreate( IpsaJitterProbe_t * pxProbe,
+                      UBaseType_t uxCpu,
+                      BaseType_t xRealTime );
+
+/*-----------------------------------------------------------*/
+
+uint64_t ullIpsaJitterNow( void )
+{
+    struct timespec xTime;
+
+    clock_gettime( CLOCK_MONOTONIC, &xTime );
+
+    return ( ( uint64_t ) xTime.tv_sec * 1000000000ULL ) + ( uint64_t ) xTime.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaJitterTick( void )
+{
+    TickType_t xTick = xTaskGetTickCountFromISR();
+    UBaseType_t uxSlot = ( UBaseType_t ) ( xTick % ipsaJITTER_TICK_HISTORY );
+
+    ullLatestTickTime = ullIpsaJitterNow();
+    xLatestTick = xTick;
+    ullTickTimes[ uxSlot ] = ullLatestTickTime;
+    xTickNumbers[ uxSlot ] = xTick;
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullIpsaJitterTickTime( TickType_t xTick )
+{
+    const uint64_t ullTickNs = 1000000000ULL / configTICK_RATE_HZ;
+    UBaseType_t uxSlot = ( UBaseType_t ) ( xTick % ipsaJITTER_TICK_HISTORY );
+    uint64_t ullTime;
+
+    taskENTER_CRITICAL();
+    {
+        if( ullLatestTickTime == 0U )
+        {
+            ullTime = 0U;
+        }
+        else if( xTickNumbers[ uxSlot ] == xTick )
+        {
+            ullTime = ullTickTimes[ uxSlot ];
+        }
+        else if( ( TickType_t ) ( xLatestTick - xTick ) <= ( portMAX_DELAY / 2U ) )
+        {
+            /* Older, or a catch up tick the hook did not see. */
+            ullTime = ullLatestTickTime - ( ( uint64_t ) ( TickType_t ) ( xLatestTick - xTick ) * ullTickNs );
+        }
+        else
+        {
+            ullTime = ullLatestTickTime + ( ( uint64_t ) ( TickType_t ) ( xTick - xLatestTick ) * ullTickNs );
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return ullTime;
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaJitterReset( IpsaJitterHistogram_t * pxHistogram )
+{
+    memset( pxHistogram, 0, sizeof( *pxHistogram ) );
+    pxHistogram->ullMin = UINT64_MAX;
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaJitterRecord( IpsaJitterHistogram_t * pxHistogram,
+                        uint64_t ullNanoseconds )
+{
+    uint64_t ullScaled = ullNanoseconds >> ipsaJITTER_SHIFT;
+    UBaseType_t uxBucket = 0;
+
+    if( ullScaled != 0U )
+    {
+        uxBucket = ( UBaseType_t ) ( 63 - __builtin_clzll( ullScaled ) );
+
+        if( uxBucket >= ipsaJITTER_BUCKETS )
+        {
+            uxBucket = ipsaJITTER_BUCKETS - 1U;
+        }
+    }
+
+    if( ullNanoseconds < pxHistogram->ullMin )
+    {
+        pxHistogram->ullMin = ullNanoseconds;
+    }
+
+    if( ullNanoseconds > pxHistogram->ullMax )
+    {
+        pxHistogram->ullMax = ullNanoseconds;
+    }
+
+    pxHistogram->ullSum += ullNanoseconds;
+    pxHistogram->ulSamples++;
+    pxHistogram->ulBuckets[ uxBucket ]++;
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullIpsaJitterPercentile( const IpsaJitterHistogram_t * pxHistogram,
+                                  UBaseType_t uxPercent )
+{
+    uint64_t ullWanted = ( ( uint64_t ) pxHistogram->ulSamples * uxPercent + 99U ) / 100U;
+    uint64_t ullSeen = 0;
+    UBaseType_t uxBucket;
+
+    for( uxBucket = 0; uxBucket < ipsaJITTER_BUCKETS - 1U; uxBucket++ )
+    {
+        ullSeen += pxHistogram->ulBuckets[ uxBucket ];
+
+        if( ullSeen >= ullWanted )
+        {
+            return 1ULL << ( uxBucket + 1U + ipsaJITTER_SHIFT );
+        }
+    }
+
+    return pxHistogram->ullMax;
+}
+/*-----------------------------------------------------------*/
+
+static void * prvProbeThread( void * pvParameter )
+{
+    JitterWorker_t * pxWorker = ( JitterWorker_t * ) pvParameter;
+    IpsaJitterProbe_t * pxProbe = pxWorker->pxProbe;
+    IpsaJitterHistogram_t * pxHistogram = &pxProbe->xCpus[ pxWorker->uxCpu ];
+    const uint64_t ullInterval = ( uint64_t ) pxProbe->ulIntervalUs * 1000U;
+    uint64_t ullNext = ullIpsaJitterNow() + ullInterval;
+    uint64_t ullNow;
+    struct timespec xWake;
+    cpu_set_t xCpus;
+    uint32_t ulLoop;
+
+    CPU_ZERO( &xCpus );
+    CPU_SET( pxWorker->uxCpu, &xCpus );
+    ( void ) pthread_setaffinity_np( pthread_self(), sizeof( xCpus ), &xCpus );
+
+    for( ulLoop = 0; ulLoop < pxProbe->ulLoops; ulLoop++ )
+    {
+        xWake.tv_sec = ( time_t ) ( ullNext / 1000000000ULL );
+        xWake.tv_nsec = ( long ) ( ullNext % 1000000000ULL );
+
+        while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &xWake, NULL ) != 0 )
+        {
+        }
+
+        ullNow = ullIpsaJitterNow();
+        vIpsaJitterRecord( pxHistogram, ullNow - ullNext );
+        ullNext += ullInterval;
+
+        /* After a very late wake up, skip the missed periods instead of
+         * counting each of them late as well. */
+        if( ullNext < ullNow )
+        {
+            ullNext = ullNow + ullInterval;
+        }
+    }
+
+    __atomic_sub_fetch( &pxProbe->ulRunning, 1U, __ATOMIC_RELEASE );
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static int prvCreate( IpsaJitterProbe_t * pxProbe,
+                      UBaseType_t uxCpu,
+                      BaseType_t xRealTime )
+{
+    pthread_attr_t xAttr;
+    struct sched_param xParam;
+    int iError;
+
+    xWorkers[ uxCpu ].pxProbe = pxProbe;
+    xWorkers[ uxCpu ].uxCpu = uxCpu;
+
+    pthread_attr_init( &xAttr );
+
+    if( xRealTime != pdFALSE )
+    {
+        xParam.sched_priority = ipsaJITTER_RT_PRIORITY;
+        pthread_attr_setinheritsched( &xAttr, PTHREAD_EXPLICIT_SCHED );
+        pthread_attr_setschedpolicy( &xAttr, SCHED_FIFO );
+        pthread_attr_setschedparam( &xAttr, &xParam );
+    }
+
+    iError = pthread_create( &pxProbe->xThreads[ uxCpu ], &xAttr, prvProbeThread, &xWorkers[ uxCpu ] );
+    pthread_attr_destroy( &xAttr );
+
+    return iError;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaJitterProbeStart( IpsaJitterProbe_t * pxProbe,
+                                  uint32_t ulIntervalUs,
+                                  uint32_t ulLoops )
+{
+    long lCpus = sysconf( _SC_NPROCESSORS_ONLN );
+    sigset_t xAll, xPrevious;
+    UBaseType_t x;
+
+    pxProbe->uxCpus = ( lCpus < 1 ) ? 1U : ( lCpus > ipsaJITTER_MAX_CPUS ) ? ipsaJITTER_MAX_CPUS : ( UBaseType_t ) lCpus;
+    pxProbe->ulIntervalUs = ulIntervalUs;
+    pxProbe->ulLoops = ulLoops;
+    pxProbe->xRealTime = pdTRUE;
+    pxProbe->ulRunning = 0;
+
+    for( x = 0; x < pxProbe->uxCpus; x++ )
+    {
+        vIpsaJitterReset( &pxProbe->xCpus[ x ] );
+    }
+
+    /* The threads inherit the signal mask of their creator. */
+    sigfillset( &xAll );
+    pthread_sigmask( SIG_BLOCK, &xAll, &xPrevious );
+
+    for( x = 0; x < pxProbe->uxCpus; x++ )
+    {
+        __atomic_add_fetch( &pxProbe->ulRunning, 1U, __ATOMIC_RELAXED );
+
+        if( ( pxProbe->xRealTime != pdFALSE ) && ( prvCreate( pxProbe, x, pdTRUE ) == 0 ) )
+        {
+            continue;
+        }
+
+        /* Without the privilege for SCHED_FIFO, measure at normal priority. */
+        pxProbe->xRealTime = pdFALSE;
+
+        if( prvCreate( pxProbe, x, pdFALSE ) != 0 )
+        {
+            __atomic_sub_fetch( &pxProbe->ulRunning, 1U, __ATOMIC_RELAXED );
+            break;
+        }
+    }
+
+    pxProbe->uxCpus = x;
+    pthread_sigmask( SIG_SETMASK, &xPrevious, NULL );
+
+    return ( pxProbe->uxCpus != 0U ) ? pdPASS : pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaJitterProbeDone( const IpsaJitterProbe_t * pxProbe )
+{
+    return ( __atomic_load_n( &pxProbe->ulRunning, __ATOMIC_ACQUIRE ) == 0U ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaJitterProbeJoin( IpsaJitterProbe_t * pxProbe )
+{
+    UBaseType_t x;
+
+    for( x = 0; x < pxProbe->uxCpus; x++ )
+    {
+        pthread_join( pxProbe->xThreads[ x ], NULL );
+    }
+}
+/*-----------------------------------------------------------*/
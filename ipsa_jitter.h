@@ -0,0 +1,123 @@
+/*
+ * Wake up jitter measurement, cyclictest style.
+ *
+ * The host probe starts one thread per online CPU, pinned to it and
+ * SCHED_FIFO when the process may use it.  Each thread sleeps with
+ * clock_nanosleep( TIMER_ABSTIME ) to the next multiple of the interval and
+ * records how late it woke up.  Run once before the scheduler starts and
+ * once while it runs, the probe separates the host's own wake up latency
+ * from what the FreeRTOS Linux port adds on top of it, which the release
+ * jitter of the tasks, recorded in the same histogram type, then shows.
+ *
+ * Histograms have power of two buckets: bucket b counts latencies in
+ * [ 2^( b + SHIFT ), 2^( b + 1 + SHIFT ) ) ns, the first and last ones are
+ * open ended.
+ *
+ * A job's release jitter is measured from the tick it was released on, as
+ * timed by vIpsaJitterTick(), so a drifting tick or a tick the port delayed
+ * shows up once, on the jobs of that tick, rather than in every later
+ * release.
+ *
+ * The probe threads are plain pthreads created with every signal blocked,
+ * so the port's tick and context switch signals are never delivered to
+ * them.  One probe runs at a time.  Linux port only.
+ */
+
+#ifndef IPSA_JITTER_H
+#define IPSA_JITTER_H
+
+#include <pthread.h>
+
+#include "FreeRTOS.h"
+
+#ifndef ipsaJITTER_MAX_CPUS
+    #define ipsaJITTER_MAX_CPUS            ( 8 )
+#endif
+
+#ifndef ipsaJITTER_BUCKETS
+    #define ipsaJITTER_BUCKETS             ( 20 )
+#endif
+
+#ifndef ipsaJITTER_SHIFT
+    #define ipsaJITTER_SHIFT               ( 10 )
+#endif
+
+/* Ticks whose start time vIpsaJitterTick() remembers. */
+#ifndef ipsaJITTER_TICK_HISTORY
+    #define ipsaJITTER_TICK_HISTORY        ( 16 )
+#endif
+
+/* SCHED_FIFO priority of the probe threads. */
+#ifndef ipsaJITTER_RT_PRIORITY
+    #define ipsaJITTER_RT_PRIORITY         ( 80 )
+#endif
+
+typedef struct IPSA_JITTER_HISTOGRAM
+{
+    uint64_t ullMin;
+    uint64_t ullMax;
+    uint64_t ullSum;
+    uint32_t ulSamples;
+    uint32_t ulBuckets[ ipsaJITTER_BUCKETS ];
+} IpsaJitterHistogram_t;
+
+typedef struct IPSA_JITTER_PROBE
+{
+    pthread_t xThreads[ ipsaJITTER_MAX_CPUS ];
+    IpsaJitterHistogram_t xCpus[ ipsaJITTER_MAX_CPUS ];
+    UBaseType_t uxCpus;
+    uint32_t ulIntervalUs;
+    uint32_t ulLoops;
+    BaseType_t xRealTime;           /* pdTRUE if the threads got SCHED_FIFO. */
+    volatile uint32_t ulRunning;    /* Threads not finished yet. */
+} IpsaJitterProbe_t;
+
+/* CLOCK_MONOTONIC in nanoseconds. */
+uint64_t ullIpsaJitterNow( void );
+
+/*
+ * Records when the current tick is processed, call from
+ * vApplicationTickHook().
+ */
+void vIpsaJitterTick( void );
+
+/*
+ * CLOCK_MONOTONIC time of tick xTick.  Exact for the last
+ * ipsaJITTER_TICK_HISTORY ticks the hook saw, extrapolated at
+ * configTICK_RATE_HZ from the latest one otherwise.  Returns 0 until
+ * vIpsaJitterTick() has run once.
+ */
+uint64_t ullIpsaJitterTickTime( TickType_t xTick );
+
+void vIpsaJitterReset( IpsaJitterHistogram_t * pxHistogram );
+
+void vIpsaJitterRecord( IpsaJitterHistogram_t * pxHistogram,
+                        uint64_t ullNanoseconds );
+
+/*
+ * Latency below which uxPercent percent of the samples fall, rounded up to
+ * a bucket bound.
+ */
+uint64_t ullIpsaJitterPercentile( const IpsaJitterHistogram_t * pxHistogram,
+                                  UBaseType_t uxPercent );
+
+/*
+ * Starts a probe thread on each online CPU, up to ipsaJITTER_MAX_CPUS,
+ * waking ulLoops times every ulIntervalUs.  Returns pdFAIL if no thread
+ * could be started.
+ */
+BaseType_t xIpsaJitterProbeStart( IpsaJitterProbe_t * pxProbe,
+                                  uint32_t ulIntervalUs,
+                                  uint32_t ulLoops );
+
+/* pdTRUE once every thread of the probe has finished.  Never blocks. */
+BaseType_t xIpsaJitterProbeDone( const IpsaJitterProbe_t * pxProbe );
+
+/*
+ * Waits for the probe threads and releases them.  This blocks the calling
+ * thread in the host, so tasks may only call it once
+ * xIpsaJitterProbeDone() returned pdTRUE.
+ */
+void vIpsaJitterProbeJoin( IpsaJitterProbe_t * pxProbe );
+
+#endif /* IPSA_JITTER_H */
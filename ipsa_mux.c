@@ -0,0 +1,128 @@
+/*
+ * Multi-source event consumer, see ipsa_mux.h.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "queue.h"
+
+/* Local includes. */
+#include "ipsa_mux.h"
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Records xMember, just selected from the set, as having one more pending
+ * event.
+ */
+static void prvMarkPending( IpsaMux_t * pxMux,
+                            QueueSetMemberHandle_t xMember );
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaMuxCreate( IpsaMux_t * pxMux,
+                           UBaseType_t uxEventLength )
+{
+    pxMux->uxSources = 0;
+    pxMux->xSet = xQueueCreateSet( uxEventLength );
+
+    return ( pxMux->xSet != NULL ) ? pdPASS : pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaMuxAddSource( IpsaMux_t * pxMux,
+                              QueueSetMemberHandle_t xMember,
+                              UBaseType_t uxPriority,
+                              IpsaMuxHandler_t pxHandler,
+                              void * pvContext )
+{
+    UBaseType_t x;
+
+    if( ( pxMux->uxSources >= ipsaMUX_MAX_SOURCES ) || ( xQueueAddToSet( xMember, pxMux->xSet ) != pdPASS ) )
+    {
+        return pdFAIL;
+    }
+
+    /* Insertion sort, behind the sources of the same priority. */
+    for( x = pxMux->uxSources; ( x > 0U ) && ( pxMux->xSources[ x - 1U ].uxPriority < uxPriority ); x-- )
+    {
+        pxMux->xSources[ x ] = pxMux->xSources[ x - 1U ];
+    }
+
+    pxMux->xSources[ x ].xMember = xMember;
+    pxMux->xSources[ x ].uxPriority = uxPriority;
+    pxMux->xSources[ x ].pxHandler = pxHandler;
+    pxMux->xSources[ x ].pvContext = pvContext;
+    pxMux->xSources[ x ].uxPending = 0;
+    pxMux->xSources[ x ].ulHandled = 0;
+    pxMux->uxSources++;
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMarkPending( IpsaMux_t * pxMux,
+                            QueueSetMemberHandle_t xMember )
+{
+    UBaseType_t x;
+
+    for( x = 0; x < pxMux->uxSources; x++ )
+    {
+        if( pxMux->xSources[ x ].xMember == xMember )
+        {
+            pxMux->xSources[ x ].uxPending++;
+            return;
+        }
+    }
+
+    /* Only members added through xIpsaMuxAddSource() are in the set. */
+    configASSERT( pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxIpsaMuxWait( IpsaMux_t * pxMux,
+                           TickType_t xTicksToWait )
+{
+    QueueSetMemberHandle_t xMember;
+    IpsaMuxSource_t * pxSource;
+    UBaseType_t x, uxHandled = 0;
+
+    xMember = xQueueSelectFromSet( pxMux->xSet, xTicksToWait );
+
+    for( ;; )
+    {
+        /* Collect everything signalled so far without blocking. */
+        while( xMember != NULL )
+        {
+            prvMarkPending( pxMux, xMember );
+            xMember = xQueueSelectFromSet( pxMux->xSet, 0 );
+        }
+
+        pxSource = NULL;
+
+        for( x = 0; x < pxMux->uxSources; x++ )
+        {
+            if( pxMux->xSources[ x ].uxPending != 0U )
+            {
+                pxSource = &pxMux->xSources[ x ];
+                break;
+            }
+        }
+
+        if( pxSource == NULL )
+        {
+            break;
+        }
+
+        /* One event, then look again for more urgent ones. */
+        pxSource->uxPending--;
+        pxSource->pxHandler( pxSource->xMember, pxSource->pvContext );
+        pxSource->ulHandled++;
+        uxHandled++;
+
+        xMember = xQueueSelectFromSet( pxMux->xSet, 0 );
+    }
+
+    return uxHandled;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,78 @@
+/*
+ * One task waiting on several event sources.
+ *
+ * A consumer of a queue, a topic and a semaphore would otherwise poll each
+ * of them in turn, or need a task per source.  The sources are added to a
+ * FreeRTOS queue set instead, so the consumer blocks on all of them at once
+ * in uxIpsaMuxWait().  When it wakes, every event already signalled is
+ * collected and the handlers run highest priority source first.  The set is
+ * checked again after each handler, so an urgent event that arrives while a
+ * routine one is handled is served next.
+ *
+ * A source is any queue set member: a queue, a semaphore, or the semaphore
+ * of a higher level object such as IpsaPrioQueue_t.xItems.  Its handler is
+ * called once per event and must consume exactly one event of its member
+ * without blocking - one xQueueReceive( x, p, 0 ) or xSemaphoreTake( x, 0 ),
+ * which is what the queue set expects.
+ *
+ * Requirements: configUSE_QUEUE_SETS must be 1.  Sources must be added
+ * while they are empty, before the tasks that signal them run.
+ */
+
+#ifndef IPSA_MUX_H
+#define IPSA_MUX_H
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+#ifndef ipsaMUX_MAX_SOURCES
+    #define ipsaMUX_MAX_SOURCES            ( 4 )
+#endif
+
+/* Consumes one event of xMember. */
+typedef void (* IpsaMuxHandler_t)( QueueSetMemberHandle_t xMember,
+                                   void * pvContext );
+
+typedef struct IPSA_MUX_SOURCE
+{
+    QueueSetMemberHandle_t xMember;
+    UBaseType_t uxPriority;
+    IpsaMuxHandler_t pxHandler;
+    void * pvContext;
+    UBaseType_t uxPending;    /* Events selected from the set but not yet handled. */
+    uint32_t ulHandled;
+} IpsaMuxSource_t;
+
+typedef struct IPSA_MUX
+{
+    QueueSetHandle_t xSet;
+    IpsaMuxSource_t xSources[ ipsaMUX_MAX_SOURCES ];    /* Highest priority first. */
+    UBaseType_t uxSources;
+} IpsaMux_t;
+
+/*
+ * Creates the queue set.  uxEventLength must be at least the sum of the
+ * lengths of the members that will be added, 1 for a binary semaphore.
+ */
+BaseType_t xIpsaMuxCreate( IpsaMux_t * pxMux,
+                           UBaseType_t uxEventLength );
+
+/*
+ * Adds xMember, whose events pxHandler consumes.  Sources of equal priority
+ * are served in the order they were added.  Returns pdFAIL if
+ * ipsaMUX_MAX_SOURCES are already added or xMember is not empty.
+ */
+BaseType_t xIpsaMuxAddSource( IpsaMux_t * pxMux,
+                              QueueSetMemberHandle_t xMember,
+                              UBaseType_t uxPriority,
+                              IpsaMuxHandler_t pxHandler,
+                              void * pvContext );
+
+/*
+ * Waits up to xTicksToWait for an event on any source, then handles every
+ * pending event in priority order.  Returns the number of events handled.
+ */
+UBaseType_t uxIpsaMuxWait( IpsaMux_t * pxMux,
+                           TickType_t xTicksToWait );
+
+#endif /* IPSA_MUX_H */
@@ -0,0 +1,177 @@
+/*
+ * Kernel overhead accounting, see ipsa_overhead.h.
+ */
+
+#include <string.h>
+#include <time.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+/* Local includes. */
+#include "ipsa_overhead.h"
+
+/*-----------------------------------------------------------*/
+
+static IpsaOverheadCounter_t xCounters[ eIpsaOverheadClasses ];
+
+/* Time the first task was switched in, 0 before. */
+static uint64_t ullEpoch = 0;
+
+/* Start of the running task's slice and of the switch in progress. */
+static uint64_t ullSliceStart = 0;
+static uint64_t ullSwitchStart = 0;
+
+/* Tick time spent inside the current slice, not charged to the task. */
+static uint64_t ullTickStart = 0;
+static uint64_t ullTickInSlice = 0;
+
+static TaskHandle_t xIdleTask = NULL;
+static TaskHandle_t xDaemonTask = NULL;
+
+static const char * const pcNames[ eIpsaOverheadClasses ] =
+{
+    "switch", "tick", "timer", "idle", "tasks"
+};
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNow( void );
+
+/*
+ * Charges ullNanoseconds to eClass as one event.  Called from the hooks,
+ * which the kernel runs with interrupts masked.
+ */
+static void prvRecord( eIpsaOverheadClass eClass,
+                       uint64_t ullNanoseconds );
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNow( void )
+{
+    struct timespec xTime;
+
+    clock_gettime( CLOCK_MONOTONIC, &xTime );
+
+    return ( ( uint64_t ) xTime.tv_sec * 1000000000ULL ) + ( uint64_t ) xTime.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRecord( eIpsaOverheadClass eClass,
+                       uint64_t ullNanoseconds )
+{
+    IpsaOverheadCounter_t * pxCounter = &xCounters[ eClass ];
+    uint64_t ullScaled = ullNanoseconds >> ipsaOVERHEAD_SHIFT;
+    UBaseType_t uxBucket = 0;
+
+    if( ullScaled != 0U )
+    {
+        uxBucket = ( UBaseType_t ) ( 63 - __builtin_clzll( ullScaled ) );
+
+        if( uxBucket >= ipsaOVERHEAD_BUCKETS )
+        {
+            uxBucket = ipsaOVERHEAD_BUCKETS - 1U;
+        }
+    }
+
+    pxCounter->ullNanoseconds += ullNanoseconds;
+    pxCounter->ulEvents++;
+    pxCounter->ulHistogram[ uxBucket ]++;
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaOverheadSwitchedOut( void )
+{
+    uint64_t ullNow = prvNow();
+    uint64_t ullSlice;
+    TaskHandle_t xTask = xTaskGetCurrentTaskHandle();
+    eIpsaOverheadClass eClass = eIpsaOverheadTasks;
+
+    if( ullSliceStart == 0U )
+    {
+        return;
+    }
+
+    ullSlice = ullNow - ullSliceStart;
+    ullSlice = ( ullSlice > ullTickInSlice ) ? ( ullSlice - ullTickInSlice ) : 0U;
+
+    if( xTask == xIdleTask )
+    {
+        eClass = eIpsaOverheadIdle;
+    }
+    else if( xTask == xDaemonTask )
+    {
+        eClass = eIpsaOverheadTimer;
+    }
+
+    prvRecord( eClass, ullSlice );
+    ullSwitchStart = ullNow;
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaOverheadSwitchedIn( void )
+{
+    uint64_t ullNow = prvNow();
+
+    if( ullEpoch == 0U )
+    {
+        /* The scheduler has created both tasks before its first switch. */
+        ullEpoch = ullNow;
+        xIdleTask = xTaskGetIdleTaskHandle();
+        xDaemonTask = xTimerGetTimerDaemonTaskHandle();
+    }
+    else if( ullSwitchStart != 0U )
+    {
+        prvRecord( eIpsaOverheadSwitch, ullNow - ullSwitchStart );
+    }
+
+    ullSwitchStart = 0;
+    ullSliceStart = ullNow;
+    ullTickInSlice = 0;
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaOverheadTickStart( void )
+{
+    ullTickStart = prvNow();
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaOverheadTickEnd( void )
+{
+    uint64_t ullTick;
+
+    if( ullTickStart == 0U )
+    {
+        return;
+    }
+
+    ullTick = prvNow() - ullTickStart;
+    ullTickStart = 0;
+    ullTickInSlice += ullTick;
+    prvRecord( eIpsaOverheadTick, ullTick );
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullIpsaOverheadSnapshot( IpsaOverheadCounter_t pxCounters[ eIpsaOverheadClasses ] )
+{
+    uint64_t ullEpochCopy;
+
+    taskENTER_CRITICAL();
+    {
+        memcpy( pxCounters, xCounters, sizeof( xCounters ) );
+        ullEpochCopy = ullEpoch;
+    }
+    taskEXIT_CRITICAL();
+
+    return ( ullEpochCopy != 0U ) ? ( prvNow() - ullEpochCopy ) : 0U;
+}
+/*-----------------------------------------------------------*/
+
+const char * pcIpsaOverheadName( eIpsaOverheadClass eClass )
+{
+    return ( eClass < eIpsaOverheadClasses ) ? pcNames[ eClass ] : "?";
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,78 @@
+/*
+ * Kernel overhead accounting.
+ *
+ * Splits CPU time between the kernel and the task bodies, measured with
+ * CLOCK_MONOTONIC from the kernel's trace hooks:
+ *   eIpsaOverheadSwitch - from a task being switched out to the next one
+ *                         being switched in, the scheduler's own work;
+ *   eIpsaOverheadTick   - the tick interrupt, from the tick count increment
+ *                         to the end of vApplicationTickHook(), so the tick
+ *                         hooks of ipsa_cbs.c and ipsa_hsched.c are included;
+ *   eIpsaOverheadTimer  - the timer daemon, which runs the xTimer commands
+ *                         and callbacks;
+ *   eIpsaOverheadIdle   - the idle task;
+ *   eIpsaOverheadTasks  - every other task, tick time excluded.
+ * Each class keeps its total, its number of events and a histogram of event
+ * durations with power of two buckets, so capacity planning can use the
+ * real kernel share and a change such as tickless idle can be judged by it.
+ *
+ * Requirements: FreeRTOSConfig.h must route the trace hooks here,
+ *     #define traceTASK_SWITCHED_OUT()         vIpsaOverheadSwitchedOut()
+ *     #define traceTASK_SWITCHED_IN()          vIpsaOverheadSwitchedIn()
+ *     #define traceTASK_INCREMENT_TICK( x )    vIpsaOverheadTickStart()
+ * vApplicationTickHook() must end with vIpsaOverheadTickEnd(), and
+ * INCLUDE_xTaskGetIdleTaskHandle and INCLUDE_xTimerGetTimerDaemonTaskHandle
+ * must be 1.
+ */
+
+#ifndef IPSA_OVERHEAD_H
+#define IPSA_OVERHEAD_H
+
+#include "FreeRTOS.h"
+
+/* Histogram buckets; bucket b counts durations in
+ * [ 2^( b + SHIFT ), 2^( b + 1 + SHIFT ) ) ns, the first and last ones are
+ * open ended. */
+#ifndef ipsaOVERHEAD_BUCKETS
+    #define ipsaOVERHEAD_BUCKETS           ( 16 )
+#endif
+
+#ifndef ipsaOVERHEAD_SHIFT
+    #define ipsaOVERHEAD_SHIFT             ( 8 )
+#endif
+
+typedef enum
+{
+    eIpsaOverheadSwitch = 0,
+    eIpsaOverheadTick,
+    eIpsaOverheadTimer,
+    eIpsaOverheadIdle,
+    eIpsaOverheadTasks,
+    eIpsaOverheadClasses
+} eIpsaOverheadClass;
+
+typedef struct IPSA_OVERHEAD_COUNTER
+{
+    uint64_t ullNanoseconds;
+    uint32_t ulEvents;
+    uint32_t ulHistogram[ ipsaOVERHEAD_BUCKETS ];
+} IpsaOverheadCounter_t;
+
+/*
+ * Trace hooks, see the requirements above.
+ */
+void vIpsaOverheadSwitchedOut( void );
+void vIpsaOverheadSwitchedIn( void );
+void vIpsaOverheadTickStart( void );
+void vIpsaOverheadTickEnd( void );
+
+/*
+ * Copies the counters of every class into pxCounters and returns the
+ * nanoseconds elapsed since the first task was switched in.
+ */
+uint64_t ullIpsaOverheadSnapshot( IpsaOverheadCounter_t pxCounters[ eIpsaOverheadClasses ] );
+
+/* Short name of a class, for reports. */
+const char * pcIpsaOverheadName( eIpsaOverheadClass eClass );
+
+#endif /* IPSA_OVERHEAD_H */
@@ -0,0 +1,18 @@
+/*
+ * Periods of the ipsa_sched task set, in milliseconds.
+ *
+ * Shared by ipsa_sched.c, which converts them to ticks, and by the host side
+ * tools, so both always see the same task set.  The periods are not
+ * harmonic; ipsa_harmonic_tool.c computes the closest harmonic set and prints
+ * replacement lines for the four definitions below.
+ */
+
+#ifndef IPSA_PERIODS_H
+#define IPSA_PERIODS_H
+
+#define TASK1_PERIOD_MS                    ( 4000UL )
+#define TASK2_PERIOD_MS                    ( 200UL )
+#define TASK3_PERIOD_MS                    ( 3000UL )
+#define TASK4_PERIOD_MS                    ( 800UL )
+
+#endif /* IPSA_PERIODS_H */
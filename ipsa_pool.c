@@ -0,0 +1,318 @@
+/*
+ * Pool of pre-created worker tasks, see ipsa_pool.h.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* Local includes. */
+#include "ipsa_pool.h"
+
+#define poolINDEX_BITS                     ( 8U )
+#define poolINDEX_MASK                     ( ( 1UL << poolINDEX_BITS ) - 1UL )
+#define poolGENERATION_MASK                ( UINT32_MAX >> poolINDEX_BITS )
+
+#if ( ipsaPOOL_MAX_JOBS > 255 )
+    #error ipsaPOOL_MAX_JOBS must fit the 8-bit slot index of a handle.
+#endif
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Worker task body, pvParameters is the pool.
+ */
+static void prvWorker( void * pvParameters );
+
+/*
+ * Takes a free slot and fills it in.  Must be called with interrupts
+ * masked.  Returns the slot index, or -1 if none is free.
+ */
+static BaseType_t prvClaimSlot( IpsaPool_t * pxPool,
+                                IpsaPoolJobFunction_t pxFunction,
+                                void * pvArgument );
+
+static IpsaPoolHandle_t prvHandle( const IpsaPool_t * pxPool,
+                                   BaseType_t xSlot );
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaPoolCreate( IpsaPool_t * pxPool,
+                            const char * pcName,
+                            UBaseType_t uxWorkers,
+                            const UBaseType_t * puxClassPriorities,
+                            configSTACK_DEPTH_TYPE usStackDepth )
+{
+    UBaseType_t x;
+
+    configASSERT( ( uxWorkers > 0U ) && ( uxWorkers <= ipsaPOOL_MAX_WORKERS ) );
+
+    for( x = 0; x < ipsaPOOL_MAX_JOBS; x++ )
+    {
+        pxPool->xJobs[ x ].pxFunction = NULL;
+        pxPool->xJobs[ x ].pvArgument = NULL;
+        pxPool->xJobs[ x ].xWaiter = NULL;
+        pxPool->xJobs[ x ].ulGeneration = 1;
+        pxPool->ucFree[ x ] = ( uint8_t ) x;
+    }
+
+    pxPool->uxFree = ipsaPOOL_MAX_JOBS;
+    pxPool->uxWorkers = 0;
+    pxPool->ulSubmitted = 0;
+    pxPool->ulCompleted = 0;
+    pxPool->ulRejected = 0;
+
+    /* A slot is in at most one class queue, so each queue can hold all of
+     * them and a send never fails. */
+    for( x = 0; x < ( UBaseType_t ) ipsaPOOL_CLASSES; x++ )
+    {
+        configASSERT( ( x == 0U ) || ( puxClassPriorities[ x ] <= puxClassPriorities[ x - 1U ] ) );
+
+        pxPool->uxClassPriority[ x ] = puxClassPriorities[ x ];
+        pxPool->xPending[ x ] = xQueueCreate( ipsaPOOL_MAX_JOBS, sizeof( uint8_t ) );
+
+        if( pxPool->xPending[ x ] == NULL )
+        {
+            return pdFAIL;
+        }
+    }
+
+    pxPool->xWork = xSemaphoreCreateCounting( ipsaPOOL_MAX_JOBS, 0 );
+
+    if( pxPool->xWork == NULL )
+    {
+        return pdFAIL;
+    }
+
+    /* Idle workers wait at the most urgent priority so that an urgent job
+     * does not sit behind tasks of intermediate priority. */
+    for( x = 0; x < uxWorkers; x++ )
+    {
+        if( xTaskCreate( prvWorker, pcName, usStackDepth, pxPool,
+                         puxClassPriorities[ eIpsaPoolUrgent ], &pxPool->xWorkers[ x ] ) != pdPASS )
+        {
+            return pdFAIL;
+        }
+
+        pxPool->uxWorkers++;
+    }
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvClaimSlot( IpsaPool_t * pxPool,
+                                IpsaPoolJobFunction_t pxFunction,
+                                void * pvArgument )
+{
+    IpsaPoolJob_t * pxJob;
+    BaseType_t xSlot;
+
+    if( pxPool->uxFree == 0U )
+    {
+        pxPool->ulRejected++;
+        return -1;
+    }
+
+    xSlot = ( BaseType_t ) pxPool->ucFree[ --pxPool->uxFree ];
+    pxJob = &pxPool->xJobs[ xSlot ];
+    pxJob->pxFunction = pxFunction;
+    pxJob->pvArgument = pvArgument;
+    pxJob->xWaiter = NULL;
+    pxPool->ulSubmitted++;
+
+    return xSlot;
+}
+/*-----------------------------------------------------------*/
+
+static IpsaPoolHandle_t prvHandle( const IpsaPool_t * pxPool,
+                                   BaseType_t xSlot )
+{
+    return ( pxPool->xJobs[ xSlot ].ulGeneration << poolINDEX_BITS ) | ( IpsaPoolHandle_t ) xSlot;
+}
+/*-----------------------------------------------------------*/
+
+IpsaPoolHandle_t xIpsaPoolSubmit( IpsaPool_t * pxPool,
+                                  IpsaPoolJobFunction_t pxFunction,
+                                  void * pvArgument,
+                                  eIpsaPoolClass eClass )
+{
+    IpsaPoolHandle_t xHandle;
+    BaseType_t xSlot;
+    uint8_t ucSlot;
+
+    configASSERT( ( eClass >= eIpsaPoolUrgent ) && ( eClass < ipsaPOOL_CLASSES ) );
+
+    taskENTER_CRITICAL();
+    {
+        xSlot = prvClaimSlot( pxPool, pxFunction, pvArgument );
+        xHandle = ( xSlot < 0 ) ? ipsaPOOL_NO_HANDLE : prvHandle( pxPool, xSlot );
+    }
+    taskEXIT_CRITICAL();
+
+    if( xSlot >= 0 )
+    {
+        ucSlot = ( uint8_t ) xSlot;
+        ( void ) xQueueSend( pxPool->xPending[ eClass ], &ucSlot, 0 );
+        ( void ) xSemaphoreGive( pxPool->xWork );
+    }
+
+    return xHandle;
+}
+/*-----------------------------------------------------------*/
+
+IpsaPoolHandle_t xIpsaPoolSubmitFromISR( IpsaPool_t * pxPool,
+                                         IpsaPoolJobFunction_t pxFunction,
+                                         void * pvArgument,
+                                         eIpsaPoolClass eClass,
+                                         BaseType_t * pxHigherPriorityTaskWoken )
+{
+    IpsaPoolHandle_t xHandle;
+    UBaseType_t uxSavedInterruptStatus;
+    BaseType_t xSlot;
+    uint8_t ucSlot;
+
+    configASSERT( ( eClass >= eIpsaPoolUrgent ) && ( eClass < ipsaPOOL_CLASSES ) );
+
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    {
+        xSlot = prvClaimSlot( pxPool, pxFunction, pvArgument );
+        xHandle = ( xSlot < 0 ) ? ipsaPOOL_NO_HANDLE : prvHandle( pxPool, xSlot );
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    if( xSlot >= 0 )
+    {
+        ucSlot = ( uint8_t ) xSlot;
+        ( void ) xQueueSendFromISR( pxPool->xPending[ eClass ], &ucSlot, pxHigherPriorityTaskWoken );
+        ( void ) xSemaphoreGiveFromISR( pxPool->xWork, pxHigherPriorityTaskWoken );
+    }
+
+    return xHandle;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaPoolIsDone( IpsaPool_t * pxPool,
+                            IpsaPoolHandle_t xHandle )
+{
+    const IpsaPoolJob_t * pxJob = &pxPool->xJobs[ xHandle & poolINDEX_MASK ];
+
+    if( xHandle == ipsaPOOL_NO_HANDLE )
+    {
+        return pdTRUE;
+    }
+
+    /* The generation moves on when the job completes. */
+    return ( pxJob->ulGeneration != ( xHandle >> poolINDEX_BITS ) ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaPoolWait( IpsaPool_t * pxPool,
+                          IpsaPoolHandle_t xHandle,
+                          TickType_t xTicksToWait )
+{
+    IpsaPoolJob_t * pxJob = &pxPool->xJobs[ xHandle & poolINDEX_MASK ];
+    TimeOut_t xTimeOut;
+    BaseType_t xDone;
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    for( ;; )
+    {
+        taskENTER_CRITICAL();
+        {
+            xDone = xIpsaPoolIsDone( pxPool, xHandle );
+
+            if( xDone == pdFALSE )
+            {
+                pxJob->xWaiter = xTaskGetCurrentTaskHandle();
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( xDone != pdFALSE )
+        {
+            return pdPASS;
+        }
+
+        if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+        {
+            break;
+        }
+
+        /* Woken by the worker, or by an unrelated notification in which case
+         * the loop checks again. */
+        ( void ) ulTaskNotifyTake( pdTRUE, xTicksToWait );
+    }
+
+    taskENTER_CRITICAL();
+    {
+        if( ( xIpsaPoolIsDone( pxPool, xHandle ) == pdFALSE ) &&
+            ( pxJob->xWaiter == xTaskGetCurrentTaskHandle() ) )
+        {
+            pxJob->xWaiter = NULL;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWorker( void * pvParameters )
+{
+    IpsaPool_t * pxPool = ( IpsaPool_t * ) pvParameters;
+    IpsaPoolJob_t * pxJob;
+    TaskHandle_t xWaiter;
+    UBaseType_t uxClass;
+    uint8_t ucSlot = 0;
+
+    for( ;; )
+    {
+        ( void ) xSemaphoreTake( pxPool->xWork, portMAX_DELAY );
+
+        /* The semaphore counts queued jobs, so one of the queues has one. */
+        for( uxClass = 0; uxClass < ( UBaseType_t ) ipsaPOOL_CLASSES; uxClass++ )
+        {
+            if( xQueueReceive( pxPool->xPending[ uxClass ], &ucSlot, 0 ) == pdPASS )
+            {
+                break;
+            }
+        }
+
+        configASSERT( uxClass < ( UBaseType_t ) ipsaPOOL_CLASSES );
+
+        pxJob = &pxPool->xJobs[ ucSlot ];
+        vTaskPrioritySet( NULL, pxPool->uxClassPriority[ uxClass ] );
+
+        pxJob->pxFunction( pxJob->pvArgument );
+
+        taskENTER_CRITICAL();
+        {
+            xWaiter = pxJob->xWaiter;
+            pxJob->xWaiter = NULL;
+            pxJob->ulGeneration = ( pxJob->ulGeneration + 1U ) & poolGENERATION_MASK;
+
+            /* Generation 0 would make the handle of slot 0 look like
+             * ipsaPOOL_NO_HANDLE. */
+            if( pxJob->ulGeneration == 0U )
+            {
+                pxJob->ulGeneration = 1;
+            }
+
+            pxPool->ucFree[ pxPool->uxFree++ ] = ucSlot;
+            pxPool->ulCompleted++;
+        }
+        taskEXIT_CRITICAL();
+
+        if( xWaiter != NULL )
+        {
+            xTaskNotifyGive( xWaiter );
+        }
+
+        vTaskPrioritySet( NULL, pxPool->uxClassPriority[ eIpsaPoolUrgent ] );
+    }
+}
+/*-----------------------------------------------------------*/
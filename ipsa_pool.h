@@ -0,0 +1,124 @@
+/*
+ * Pool of pre-created worker tasks for short, ad-hoc jobs.
+ *
+ * Creating a task per job costs a TCB and a stack allocation plus the
+ * deletion in the idle task.  A pool creates its workers once, after which
+ * tasks and timer callbacks submit jobs without allocating: a job is a
+ * function and an argument stored in a fixed slot, queued in one of
+ * ipsaPOOL_CLASSES priority classes.  Idle workers wait at the priority of
+ * the most urgent class, take the most urgent queued job and run it at the
+ * priority of its class.
+ *
+ * Submission returns a completion handle that can be polled or waited on,
+ * or ignored for fire-and-forget jobs.  Handles carry a generation count, so
+ * a stale handle of a finished job never matches the slot's next job.
+ *
+ * Requirements: INCLUDE_xTaskGetCurrentTaskHandle must be 1.
+ * xIpsaPoolWait() blocks on the task notification of the caller, which
+ * must not use it for anything else while waiting.
+ */
+
+#ifndef IPSA_POOL_H
+#define IPSA_POOL_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* Job slots per pool, i.e. jobs queued or running at once. */
+#ifndef ipsaPOOL_MAX_JOBS
+    #define ipsaPOOL_MAX_JOBS              ( 16 )
+#endif
+
+#ifndef ipsaPOOL_MAX_WORKERS
+    #define ipsaPOOL_MAX_WORKERS           ( 4 )
+#endif
+
+/* Handle of no job, returned when a submission is rejected. */
+#define ipsaPOOL_NO_HANDLE                 ( ( IpsaPoolHandle_t ) 0 )
+
+/* Priority classes, most urgent first. */
+typedef enum
+{
+    eIpsaPoolUrgent = 0,
+    eIpsaPoolNormal,
+    eIpsaPoolBackground,
+    ipsaPOOL_CLASSES
+} eIpsaPoolClass;
+
+typedef void (* IpsaPoolJobFunction_t)( void * pvArgument );
+
+/* Slot index in the low 8 bits, slot generation above. */
+typedef uint32_t IpsaPoolHandle_t;
+
+typedef struct IPSA_POOL_JOB
+{
+    IpsaPoolJobFunction_t pxFunction;
+    void * pvArgument;
+    TaskHandle_t xWaiter;    /* Task blocked in xIpsaPoolWait(), or NULL. */
+    uint32_t ulGeneration;   /* Bumped when the job completes. */
+} IpsaPoolJob_t;
+
+typedef struct IPSA_POOL
+{
+    IpsaPoolJob_t xJobs[ ipsaPOOL_MAX_JOBS ];
+    uint8_t ucFree[ ipsaPOOL_MAX_JOBS ];                   /* Stack of free slot indices. */
+    UBaseType_t uxFree;
+    QueueHandle_t xPending[ ipsaPOOL_CLASSES ];            /* Queued slot indices per class. */
+    SemaphoreHandle_t xWork;                               /* Counts queued jobs. */
+    UBaseType_t uxClassPriority[ ipsaPOOL_CLASSES ];
+    TaskHandle_t xWorkers[ ipsaPOOL_MAX_WORKERS ];
+    UBaseType_t uxWorkers;
+    uint32_t ulSubmitted;
+    uint32_t ulCompleted;
+    uint32_t ulRejected;                                   /* Submissions with no free slot. */
+} IpsaPool_t;
+
+/*
+ * Creates the queues and uxWorkers worker tasks of usStackDepth words.
+ * puxClassPriorities gives the priority jobs of each class run at, most
+ * urgent class first and in non increasing order.  Call before the
+ * scheduler starts or from a task; returns pdFAIL if anything could not be
+ * allocated.
+ */
+BaseType_t xIpsaPoolCreate( IpsaPool_t * pxPool,
+                            const char * pcName,
+                            UBaseType_t uxWorkers,
+                            const UBaseType_t * puxClassPriorities,
+                            configSTACK_DEPTH_TYPE usStackDepth );
+
+/*
+ * Queues pxFunction( pvArgument ) in class eClass without blocking.
+ * Returns the completion handle, or ipsaPOOL_NO_HANDLE if every job slot is
+ * in use.  Safe from tasks and timer callbacks.
+ */
+IpsaPoolHandle_t xIpsaPoolSubmit( IpsaPool_t * pxPool,
+                                  IpsaPoolJobFunction_t pxFunction,
+                                  void * pvArgument,
+                                  eIpsaPoolClass eClass );
+
+/*
+ * As xIpsaPoolSubmit(), from an interrupt.
+ */
+IpsaPoolHandle_t xIpsaPoolSubmitFromISR( IpsaPool_t * pxPool,
+                                         IpsaPoolJobFunction_t pxFunction,
+                                         void * pvArgument,
+                                         eIpsaPoolClass eClass,
+                                         BaseType_t * pxHigherPriorityTaskWoken );
+
+/*
+ * pdTRUE once the job of xHandle has completed.
+ */
+BaseType_t xIpsaPoolIsDone( IpsaPool_t * pxPool,
+                            IpsaPoolHandle_t xHandle );
+
+/*
+ * Blocks for at most xTicksToWait until the job of xHandle has completed.
+ * Returns pdPASS if it has, pdFAIL on timeout.  One waiter per job.
+ */
+BaseType_t xIpsaPoolWait( IpsaPool_t * pxPool,
+                          IpsaPoolHandle_t xHandle,
+                          TickType_t xTicksToWait );
+
+#endif /* IPSA_POOL_H */
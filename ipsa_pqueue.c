@@ -0,0 +1,207 @@
+/*
+ * Priority ordered message queue, see ipsa_pqueue.h.
+ */
+
+#include <string.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Local includes. */
+#include "ipsa_pqueue.h"
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Copies pvItem into the ring of uxPriority.  Must be called with
+ * interrupts masked and a place reserved.
+ */
+static void prvPush( IpsaPrioQueue_t * pxQueue,
+                     const void * pvItem,
+                     UBaseType_t uxPriority );
+
+/*
+ * Takes the oldest message of the highest non-empty level.  Must be called
+ * with interrupts masked and a message reserved.
+ */
+static void prvPop( IpsaPrioQueue_t * pxQueue,
+                    void * pvBuffer,
+                    UBaseType_t * puxPriority );
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaPrioQueueCreate( IpsaPrioQueue_t * pxQueue,
+                                 UBaseType_t uxLength,
+                                 UBaseType_t uxItemSize,
+                                 UBaseType_t uxLevels )
+{
+    UBaseType_t x;
+
+    configASSERT( ( uxLength > 0U ) && ( uxLevels > 0U ) && ( uxLevels <= ipsaPQUEUE_MAX_LEVELS ) );
+
+    pxQueue->uxLength = uxLength;
+    pxQueue->uxItemSize = uxItemSize;
+    pxQueue->uxLevels = uxLevels;
+    pxQueue->ulReadyLevels = 0;
+
+    for( x = 0; x < uxLevels; x++ )
+    {
+        pxQueue->xLevels[ x ].uxHead = 0;
+        pxQueue->xLevels[ x ].uxCount = 0;
+    }
+
+    pxQueue->pucStorage = ( uint8_t * ) pvPortMalloc( uxLevels * uxLength * uxItemSize );
+    pxQueue->xItems = xSemaphoreCreateCounting( uxLength, 0 );
+    pxQueue->xSpaces = xSemaphoreCreateCounting( uxLength, uxLength );
+
+    return ( ( pxQueue->pucStorage != NULL ) && ( pxQueue->xItems != NULL ) && ( pxQueue->xSpaces != NULL ) ) ? pdPASS : pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPush( IpsaPrioQueue_t * pxQueue,
+                     const void * pvItem,
+                     UBaseType_t uxPriority )
+{
+    IpsaPrioQueueLevel_t * pxLevel = &pxQueue->xLevels[ uxPriority ];
+    UBaseType_t uxTail = ( pxLevel->uxHead + pxLevel->uxCount ) % pxQueue->uxLength;
+
+    memcpy( &pxQueue->pucStorage[ ( ( uxPriority * pxQueue->uxLength ) + uxTail ) * pxQueue->uxItemSize ],
+            pvItem, pxQueue->uxItemSize );
+    pxLevel->uxCount++;
+    pxQueue->ulReadyLevels |= ( 1UL << uxPriority );
+}
+/*-----------------------------------------------------------*/
+
+static void prvPop( IpsaPrioQueue_t * pxQueue,
+                    void * pvBuffer,
+                    UBaseType_t * puxPriority )
+{
+    UBaseType_t uxPriority;
+    IpsaPrioQueueLevel_t * pxLevel;
+
+    configASSERT( pxQueue->ulReadyLevels != 0U );
+
+    /* Highest set bit, as the kernel's optimised task selection does. */
+    uxPriority = 31U - ( UBaseType_t ) __builtin_clz( pxQueue->ulReadyLevels );
+    pxLevel = &pxQueue->xLevels[ uxPriority ];
+
+    memcpy( pvBuffer,
+            &pxQueue->pucStorage[ ( ( uxPriority * pxQueue->uxLength ) + pxLevel->uxHead ) * pxQueue->uxItemSize ],
+            pxQueue->uxItemSize );
+    pxLevel->uxHead = ( pxLevel->uxHead + 1U ) % pxQueue->uxLength;
+
+    if( --pxLevel->uxCount == 0U )
+    {
+        pxQueue->ulReadyLevels &= ~( 1UL << uxPriority );
+    }
+
+    if( puxPriority != NULL )
+    {
+        *puxPriority = uxPriority;
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaPrioQueueSend( IpsaPrioQueue_t * pxQueue,
+                               const void * pvItem,
+                               UBaseType_t uxPriority,
+                               TickType_t xTicksToWait )
+{
+    configASSERT( uxPriority < pxQueue->uxLevels );
+
+    if( xSemaphoreTake( pxQueue->xSpaces, xTicksToWait ) != pdPASS )
+    {
+        return errQUEUE_FULL;
+    }
+
+    taskENTER_CRITICAL();
+    {
+        prvPush( pxQueue, pvItem, uxPriority );
+    }
+    taskEXIT_CRITICAL();
+
+    ( void ) xSemaphoreGive( pxQueue->xItems );
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaPrioQueueSendFromISR( IpsaPrioQueue_t * pxQueue,
+                                      const void * pvItem,
+                                      UBaseType_t uxPriority,
+                                      BaseType_t * pxHigherPriorityTaskWoken )
+{
+    UBaseType_t uxSavedInterruptStatus;
+
+    configASSERT( uxPriority < pxQueue->uxLevels );
+
+    if( xSemaphoreTakeFromISR( pxQueue->xSpaces, pxHigherPriorityTaskWoken ) != pdPASS )
+    {
+        return errQUEUE_FULL;
+    }
+
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    {
+        prvPush( pxQueue, pvItem, uxPriority );
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    ( void ) xSemaphoreGiveFromISR( pxQueue->xItems, pxHigherPriorityTaskWoken );
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaPrioQueueReceive( IpsaPrioQueue_t * pxQueue,
+                                  void * pvBuffer,
+                                  UBaseType_t * puxPriority,
+                                  TickType_t xTicksToWait )
+{
+    if( xSemaphoreTake( pxQueue->xItems, xTicksToWait ) != pdPASS )
+    {
+        return pdFAIL;
+    }
+
+    taskENTER_CRITICAL();
+    {
+        prvPop( pxQueue, pvBuffer, puxPriority );
+    }
+    taskEXIT_CRITICAL();
+
+    ( void ) xSemaphoreGive( pxQueue->xSpaces );
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaPrioQueueReceiveFromISR( IpsaPrioQueue_t * pxQueue,
+                                         void * pvBuffer,
+                                         UBaseType_t * puxPriority,
+                                         BaseType_t * pxHigherPriorityTaskWoken )
+{
+    UBaseType_t uxSavedInterruptStatus;
+
+    if( xSemaphoreTakeFromISR( pxQueue->xItems, pxHigherPriorityTaskWoken ) != pdPASS )
+    {
+        return pdFAIL;
+    }
+
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    {
+        prvPop( pxQueue, pvBuffer, puxPriority );
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    ( void ) xSemaphoreGiveFromISR( pxQueue->xSpaces, pxHigherPriorityTaskWoken );
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxIpsaPrioQueueMessagesWaiting( const IpsaPrioQueue_t * pxQueue )
+{
+    return uxSemaphoreGetCount( pxQueue->xItems );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,83 @@
+/*
+ * Message queue that delivers by message priority.
+ *
+ * A FreeRTOS queue is FIFO, so an urgent message waits behind every routine
+ * message queued before it.  Here each priority level has its own ring and a
+ * bitmap records the non-empty levels, so receive takes the oldest message
+ * of the highest non-empty level in constant time, the same way the kernel
+ * picks the highest ready priority.  Messages of equal priority stay FIFO.
+ *
+ * Blocking follows xQueueSend() / xQueueReceive(): senders wait while all
+ * uxLength places are taken, receivers wait while the queue is empty, both
+ * up to their timeout.  Each level's ring can hold the whole capacity, so a
+ * burst on one level never fails while places are free.
+ */
+
+#ifndef IPSA_PQUEUE_H
+#define IPSA_PQUEUE_H
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/* Largest number of levels, one bit each in the bitmap. */
+#define ipsaPQUEUE_MAX_LEVELS              ( 32U )
+
+typedef struct IPSA_PQUEUE_LEVEL
+{
+    UBaseType_t uxHead;    /* Next message to receive. */
+    UBaseType_t uxCount;
+} IpsaPrioQueueLevel_t;
+
+typedef struct IPSA_PQUEUE
+{
+    uint8_t * pucStorage;                                  /* uxLevels rings of uxLength items. */
+    UBaseType_t uxLength;
+    UBaseType_t uxItemSize;
+    UBaseType_t uxLevels;
+    volatile uint32_t ulReadyLevels;                       /* Bit n set while level n holds messages. */
+    IpsaPrioQueueLevel_t xLevels[ ipsaPQUEUE_MAX_LEVELS ];
+    SemaphoreHandle_t xItems;                              /* Counts queued messages. */
+    SemaphoreHandle_t xSpaces;                             /* Counts free places. */
+} IpsaPrioQueue_t;
+
+/*
+ * Creates a queue of uxLength items of uxItemSize bytes with priorities
+ * 0 (lowest) to uxLevels - 1.  Returns pdFAIL if allocation failed.
+ */
+BaseType_t xIpsaPrioQueueCreate( IpsaPrioQueue_t * pxQueue,
+                                 UBaseType_t uxLength,
+                                 UBaseType_t uxItemSize,
+                                 UBaseType_t uxLevels );
+
+/*
+ * Queues a copy of pvItem at priority uxPriority, waiting at most
+ * xTicksToWait for a free place.  Returns pdPASS or errQUEUE_FULL.
+ */
+BaseType_t xIpsaPrioQueueSend( IpsaPrioQueue_t * pxQueue,
+                               const void * pvItem,
+                               UBaseType_t uxPriority,
+                               TickType_t xTicksToWait );
+
+BaseType_t xIpsaPrioQueueSendFromISR( IpsaPrioQueue_t * pxQueue,
+                                      const void * pvItem,
+                                      UBaseType_t uxPriority,
+                                      BaseType_t * pxHigherPriorityTaskWoken );
+
+/*
+ * Copies the oldest message of the highest priority into pvBuffer, waiting
+ * at most xTicksToWait for one.  Its priority is returned in *puxPriority
+ * unless that is NULL.  Returns pdPASS or pdFAIL.
+ */
+BaseType_t xIpsaPrioQueueReceive( IpsaPrioQueue_t * pxQueue,
+                                  void * pvBuffer,
+                                  UBaseType_t * puxPriority,
+                                  TickType_t xTicksToWait );
+
+BaseType_t xIpsaPrioQueueReceiveFromISR( IpsaPrioQueue_t * pxQueue,
+                                         void * pvBuffer,
+                                         UBaseType_t * puxPriority,
+                                         BaseType_t * pxHigherPriorityTaskWoken );
+
+UBaseType_t uxIpsaPrioQueueMessagesWaiting( const IpsaPrioQueue_t * pxQueue );
+
+#endif /* IPSA_PQUEUE_H */
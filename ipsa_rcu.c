@@ -0,0 +1,157 @@
+/*
+ * Read-copy-update style publication of read mostly data, see ipsa_rcu.h.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "ipsa_rcu.h"
+
+/* Reader slot value of a reader that is offline. */
+#define rcuOFFLINE                         ( UINT32_MAX )
+
+/*-----------------------------------------------------------*/
+
+void vIpsaRcuInit( IpsaRcu_t * pxRcu,
+                   void * pvInitial,
+                   IpsaRcuFree_t pxFree )
+{
+    UBaseType_t x;
+
+    pxRcu->pvCurrent = pvInitial;
+    pxRcu->ulEpoch = 0;
+    pxRcu->uxReaders = 0;
+    pxRcu->uxRetired = 0;
+    pxRcu->pxFree = pxFree;
+
+    for( x = 0; x < ipsaRCU_MAX_READERS; x++ )
+    {
+        pxRcu->ulReaderEpoch[ x ] = rcuOFFLINE;
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaRcuRegisterReader( IpsaRcu_t * pxRcu )
+{
+    BaseType_t xReader = -1;
+
+    taskENTER_CRITICAL();
+    {
+        if( pxRcu->uxReaders < ipsaRCU_MAX_READERS )
+        {
+            xReader = ( BaseType_t ) pxRcu->uxReaders++;
+            pxRcu->ulReaderEpoch[ xReader ] = pxRcu->ulEpoch;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReader;
+}
+/*-----------------------------------------------------------*/
+
+void * pvIpsaRcuDereference( IpsaRcu_t * pxRcu )
+{
+    /* Acquire pairs with the release in xIpsaRcuPublish(), the contents of
+     * the version are visible before its pointer is. */
+    return __atomic_load_n( &pxRcu->pvCurrent, __ATOMIC_ACQUIRE );
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaRcuQuiescent( IpsaRcu_t * pxRcu,
+                        BaseType_t xReader )
+{
+    uint32_t ulEpoch = __atomic_load_n( &pxRcu->ulEpoch, __ATOMIC_ACQUIRE );
+
+    /* Release orders every earlier read of the data before the report. */
+    __atomic_store_n( &pxRcu->ulReaderEpoch[ xReader ], ulEpoch, __ATOMIC_RELEASE );
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaRcuOffline( IpsaRcu_t * pxRcu,
+                      BaseType_t xReader )
+{
+    __atomic_store_n( &pxRcu->ulReaderEpoch[ xReader ], rcuOFFLINE, __ATOMIC_RELEASE );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaRcuPublish( IpsaRcu_t * pxRcu,
+                            void * pvVersion )
+{
+    void * pvOld;
+    uint32_t ulEpoch;
+
+    if( uxIpsaRcuReclaim( pxRcu ) >= ipsaRCU_MAX_RETIRED )
+    {
+        return pdFAIL;
+    }
+
+    pvOld = __atomic_exchange_n( &pxRcu->pvCurrent, pvVersion, __ATOMIC_ACQ_REL );
+
+    /* Readers that report this epoch or a later one did so after the swap
+     * and can no longer hold pvOld. */
+    ulEpoch = __atomic_add_fetch( &pxRcu->ulEpoch, 1U, __ATOMIC_ACQ_REL );
+
+    pxRcu->pvRetired[ pxRcu->uxRetired ] = pvOld;
+    pxRcu->ulRetiredEpoch[ pxRcu->uxRetired ] = ulEpoch;
+    pxRcu->uxRetired++;
+
+    ( void ) uxIpsaRcuReclaim( pxRcu );
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxIpsaRcuReclaim( IpsaRcu_t * pxRcu )
+{
+    UBaseType_t x, y, uxKept = 0;
+    uint32_t ulReader;
+    BaseType_t xGraceOver;
+
+    for( x = 0; x < pxRcu->uxRetired; x++ )
+    {
+        xGraceOver = pdTRUE;
+
+        for( y = 0; y < pxRcu->uxReaders; y++ )
+        {
+            ulReader = __atomic_load_n( &pxRcu->ulReaderEpoch[ y ], __ATOMIC_ACQUIRE );
+
+            /* Epochs are compared with wrap around in mind. */
+            if( ( ulReader != rcuOFFLINE ) && ( ( int32_t ) ( ulReader - pxRcu->ulRetiredEpoch[ x ] ) < 0 ) )
+            {
+                xGraceOver = pdFALSE;
+                break;
+            }
+        }
+
+        if( xGraceOver != pdFALSE )
+        {
+            if( ( pxRcu->pxFree != NULL ) && ( pxRcu->pvRetired[ x ] != NULL ) )
+            {
+                pxRcu->pxFree( pxRcu->pvRetired[ x ] );
+            }
+        }
+        else
+        {
+            pxRcu->pvRetired[ uxKept ] = pxRcu->pvRetired[ x ];
+            pxRcu->ulRetiredEpoch[ uxKept ] = pxRcu->ulRetiredEpoch[ x ];
+            uxKept++;
+        }
+    }
+
+    pxRcu->uxRetired = uxKept;
+
+    return uxKept;
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaRcuSynchronize( IpsaRcu_t * pxRcu,
+                          TickType_t xPollTicks )
+{
+    while( uxIpsaRcuReclaim( pxRcu ) > 0U )
+    {
+        vTaskDelay( xPollTicks );
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,98 @@
+/*
+ * Read-copy-update style publication of read mostly data.
+ *
+ * Readers fetch the current version with pvIpsaRcuDereference() and report a
+ * quiescent point, typically at the end of each job, once they no longer hold
+ * any pointer obtained earlier.  Neither call blocks or takes a lock.  The
+ * writer builds a new version off line and swaps it in with
+ * xIpsaRcuPublish(); the previous version is only handed to the free
+ * function after every registered reader has passed a quiescent point, so a
+ * reader can never see a partially built or already freed version.
+ *
+ * There must be a single writer per IpsaRcu_t.
+ */
+
+#ifndef IPSA_RCU_H
+#define IPSA_RCU_H
+
+#include "FreeRTOS.h"
+
+#ifndef ipsaRCU_MAX_READERS
+    #define ipsaRCU_MAX_READERS            ( 4 )
+#endif
+
+/* Versions waiting for their grace period to end. */
+#ifndef ipsaRCU_MAX_RETIRED
+    #define ipsaRCU_MAX_RETIRED            ( 4 )
+#endif
+
+typedef void (* IpsaRcuFree_t)( void * pvVersion );
+
+typedef struct IPSA_RCU
+{
+    void * volatile pvCurrent;                              /* Published version. */
+    volatile uint32_t ulEpoch;                              /* Bumped by every publication. */
+    volatile uint32_t ulReaderEpoch[ ipsaRCU_MAX_READERS ]; /* Epoch at each reader's last quiescent point. */
+    UBaseType_t uxReaders;
+    void * pvRetired[ ipsaRCU_MAX_RETIRED ];
+    uint32_t ulRetiredEpoch[ ipsaRCU_MAX_RETIRED ];
+    UBaseType_t uxRetired;
+    IpsaRcuFree_t pxFree;
+} IpsaRcu_t;
+
+/*
+ * Initialises the domain with its first version.  pxFree releases retired
+ * versions, it may be NULL for statically allocated ones.
+ */
+void vIpsaRcuInit( IpsaRcu_t * pxRcu,
+                   void * pvInitial,
+                   IpsaRcuFree_t pxFree );
+
+/*
+ * Registers a reader.  Returns its id, or -1 if ipsaRCU_MAX_READERS readers
+ * are already registered.  Call before the reader first dereferences.
+ */
+BaseType_t xIpsaRcuRegisterReader( IpsaRcu_t * pxRcu );
+
+/*
+ * Current version.  Wait free.
+ */
+void * pvIpsaRcuDereference( IpsaRcu_t * pxRcu );
+
+/*
+ * Tells the writer that reader xReader holds no pointer obtained before this
+ * call.  Wait free.
+ */
+void vIpsaRcuQuiescent( IpsaRcu_t * pxRcu,
+                        BaseType_t xReader );
+
+/*
+ * Marks a reader that will not dereference for a long time (for example
+ * before it is deleted) so it does not hold up grace periods.  The next
+ * vIpsaRcuQuiescent() brings it back.
+ */
+void vIpsaRcuOffline( IpsaRcu_t * pxRcu,
+                      BaseType_t xReader );
+
+/*
+ * Swaps in pvVersion and retires the previous version.  Returns pdFAIL,
+ * without publishing, if ipsaRCU_MAX_RETIRED versions are still waiting for
+ * their grace period; call vIpsaRcuSynchronize() and retry.
+ */
+BaseType_t xIpsaRcuPublish( IpsaRcu_t * pxRcu,
+                            void * pvVersion );
+
+/*
+ * Frees the retired versions whose grace period has ended.  Returns the
+ * number still waiting.
+ */
+UBaseType_t uxIpsaRcuReclaim( IpsaRcu_t * pxRcu );
+
+/*
+ * Blocks the writer, polling every xPollTicks, until every retired version
+ * has been freed.
+ */
+void vIpsaRcuSynchronize( IpsaRcu_t * pxRcu,
+                          TickType_t xPollTicks );
+
+#endif /* IPSA_RCU_H */
@@ -0,0 +1,308 @@
+/*
+ * Request/response calls between tasks, see ipsa_rpc.h.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Local includes. */
+#include "ipsa_rpc.h"
+
+#define rpcSLOT_BITS                       ( 8U )
+#define rpcSLOT_MASK                       ( ( 1UL << rpcSLOT_BITS ) - 1UL )
+
+#if ( ipsaRPC_MAX_OUTSTANDING > 255 )
+    #error ipsaRPC_MAX_OUTSTANDING must fit the 8-bit slot index of a future.
+#endif
+
+/* What travels through the server queue. */
+typedef struct RPC_REQUEST
+{
+    IpsaRpcClient_t * pxClient;
+    IpsaFuture_t xFuture;
+    uint32_t ulOpcode;
+    uint32_t ulArgument;
+} RpcRequest_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Stores the result in the client slot if the call is still awaited and
+ * wakes the client.
+ */
+static void prvReply( IpsaRpcClient_t * pxClient,
+                      IpsaFuture_t xFuture,
+                      uint32_t ulResult );
+
+/*
+ * Releases the slot of xFuture if it still belongs to it.
+ */
+static void prvAbandon( IpsaRpcClient_t * pxClient,
+                        IpsaFuture_t xFuture );
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaRpcServerCreate( IpsaRpcServer_t * pxServer,
+                                 UBaseType_t uxQueueLength,
+                                 IpsaRpcHandler_t pxHandler,
+                                 void * pvContext )
+{
+    pxServer->pxHandler = pxHandler;
+    pxServer->pvContext = pvContext;
+    pxServer->ulServed = 0;
+    pxServer->ulLargestBatch = 0;
+    pxServer->xRequests = xQueueCreate( uxQueueLength, sizeof( RpcRequest_t ) );
+
+    return ( pxServer->xRequests != NULL ) ? pdPASS : pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxIpsaRpcServe( IpsaRpcServer_t * pxServer,
+                            TickType_t xTicksToWait )
+{
+    RpcRequest_t xRequest;
+    UBaseType_t uxServed = 0;
+
+    /* Block for the first request only, then take whatever else queued up
+     * meanwhile so a pipelined batch is answered in one activation. */
+    while( xQueueReceive( pxServer->xRequests, &xRequest, ( uxServed == 0U ) ? xTicksToWait : 0 ) == pdPASS )
+    {
+        prvReply( xRequest.pxClient, xRequest.xFuture,
+                  pxServer->pxHandler( xRequest.ulOpcode, xRequest.ulArgument, pxServer->pvContext ) );
+        uxServed++;
+    }
+
+    pxServer->ulServed += ( uint32_t ) uxServed;
+
+    if( uxServed > pxServer->ulLargestBatch )
+    {
+        pxServer->ulLargestBatch = ( uint32_t ) uxServed;
+    }
+
+    return uxServed;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReply( IpsaRpcClient_t * pxClient,
+                      IpsaFuture_t xFuture,
+                      uint32_t ulResult )
+{
+    IpsaRpcSlot_t * pxSlot = &pxClient->xSlots[ xFuture & rpcSLOT_MASK ];
+    TaskHandle_t xWake = NULL;
+
+    taskENTER_CRITICAL();
+    {
+        if( pxSlot->xFuture == xFuture )
+        {
+            pxSlot->ulResult = ulResult;
+            pxSlot->xReady = pdTRUE;
+            xWake = pxClient->xTask;
+        }
+        else
+        {
+            pxClient->ulLateReplies++;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( xWake != NULL )
+    {
+        xTaskNotifyGive( xWake );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaRpcClientInit( IpsaRpcClient_t * pxClient )
+{
+    UBaseType_t x;
+
+    pxClient->xTask = xTaskGetCurrentTaskHandle();
+    pxClient->ulSequence = 0;
+    pxClient->ulLateReplies = 0;
+
+    for( x = 0; x < ipsaRPC_MAX_OUTSTANDING; x++ )
+    {
+        pxClient->xSlots[ x ].xFuture = ipsaRPC_NO_FUTURE;
+        pxClient->xSlots[ x ].ulResult = 0;
+        pxClient->xSlots[ x ].xReady = pdFALSE;
+    }
+}
+/*-----------------------------------------------------------*/
+
+IpsaFuture_t xIpsaRpcCall( IpsaRpcClient_t * pxClient,
+                           IpsaRpcServer_t * pxServer,
+                           uint32_t ulOpcode,
+                           uint32_t ulArgument,
+                           TickType_t xTicksToWait )
+{
+    RpcRequest_t xRequest;
+    UBaseType_t x;
+
+    for( x = 0; x < ipsaRPC_MAX_OUTSTANDING; x++ )
+    {
+        if( pxClient->xSlots[ x ].xFuture == ipsaRPC_NO_FUTURE )
+        {
+            break;
+        }
+    }
+
+    if( x == ipsaRPC_MAX_OUTSTANDING )
+    {
+        return ipsaRPC_NO_FUTURE;
+    }
+
+    /* A fresh sequence number per call, never 0 so that slot 0 cannot
+     * produce ipsaRPC_NO_FUTURE. */
+    pxClient->ulSequence = ( pxClient->ulSequence + 1U ) & ( UINT32_MAX >> rpcSLOT_BITS );
+
+    if( pxClient->ulSequence == 0U )
+    {
+        pxClient->ulSequence = 1;
+    }
+
+    xRequest.pxClient = pxClient;
+    xRequest.xFuture = ( pxClient->ulSequence << rpcSLOT_BITS ) | ( IpsaFuture_t ) x;
+    xRequest.ulOpcode = ulOpcode;
+    xRequest.ulArgument = ulArgument;
+
+    /* Only the owning task fills slots; the server reads xFuture under a
+     * critical section, so set it before the request can be seen. */
+    taskENTER_CRITICAL();
+    {
+        pxClient->xSlots[ x ].xReady = pdFALSE;
+        pxClient->xSlots[ x ].xFuture = xRequest.xFuture;
+    }
+    taskEXIT_CRITICAL();
+
+    if( xQueueSend( pxServer->xRequests, &xRequest, xTicksToWait ) != pdPASS )
+    {
+        prvAbandon( pxClient, xRequest.xFuture );
+        return ipsaRPC_NO_FUTURE;
+    }
+
+    return xRequest.xFuture;
+}
+/*-----------------------------------------------------------*/
+
+static void prvAbandon( IpsaRpcClient_t * pxClient,
+                        IpsaFuture_t xFuture )
+{
+    IpsaRpcSlot_t * pxSlot = &pxClient->xSlots[ xFuture & rpcSLOT_MASK ];
+
+    if( xFuture == ipsaRPC_NO_FUTURE )
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    {
+        if( pxSlot->xFuture == xFuture )
+        {
+            pxSlot->xFuture = ipsaRPC_NO_FUTURE;
+            pxSlot->xReady = pdFALSE;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaRpcPoll( IpsaRpcClient_t * pxClient,
+                         IpsaFuture_t xFuture,
+                         uint32_t * pulResult )
+{
+    IpsaRpcSlot_t * pxSlot = &pxClient->xSlots[ xFuture & rpcSLOT_MASK ];
+    BaseType_t xReturn = pdFALSE;
+
+    if( xFuture == ipsaRPC_NO_FUTURE )
+    {
+        return pdFALSE;
+    }
+
+    taskENTER_CRITICAL();
+    {
+        if( ( pxSlot->xFuture == xFuture ) && ( pxSlot->xReady != pdFALSE ) )
+        {
+            *pulResult = pxSlot->ulResult;
+            pxSlot->xFuture = ipsaRPC_NO_FUTURE;
+            pxSlot->xReady = pdFALSE;
+            xReturn = pdTRUE;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaRpcAwait( IpsaRpcClient_t * pxClient,
+                          IpsaFuture_t xFuture,
+                          uint32_t * pulResult,
+                          TickType_t xTicksToWait )
+{
+    return ( uxIpsaRpcAwaitAll( pxClient, &xFuture, pulResult, 1U, xTicksToWait ) == 1U ) ? pdPASS : pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxIpsaRpcAwaitAll( IpsaRpcClient_t * pxClient,
+                               IpsaFuture_t * pxFutures,
+                               uint32_t * pulResults,
+                               UBaseType_t uxCount,
+                               TickType_t xTicksToWait )
+{
+    BaseType_t xCompleted[ ipsaRPC_MAX_OUTSTANDING ] = { pdFALSE };
+    TimeOut_t xTimeOut;
+    UBaseType_t uxDone = 0, uxSettled = 0, x;
+
+    /* A client never has more calls outstanding than it has slots. */
+    configASSERT( uxCount <= ipsaRPC_MAX_OUTSTANDING );
+    configASSERT( pxClient->xTask == xTaskGetCurrentTaskHandle() );
+
+    /* Calls that were never made have no reply to wait for. */
+    for( x = 0; x < uxCount; x++ )
+    {
+        if( pxFutures[ x ] == ipsaRPC_NO_FUTURE )
+        {
+            xCompleted[ x ] = pdTRUE;
+            uxSettled++;
+        }
+    }
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    for( ;; )
+    {
+        for( x = 0; x < uxCount; x++ )
+        {
+            if( ( xCompleted[ x ] == pdFALSE ) &&
+                ( xIpsaRpcPoll( pxClient, pxFutures[ x ], &pulResults[ x ] ) != pdFALSE ) )
+            {
+                xCompleted[ x ] = pdTRUE;
+                uxDone++;
+                uxSettled++;
+            }
+        }
+
+        if( ( uxSettled == uxCount ) || ( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE ) )
+        {
+            break;
+        }
+
+        /* Every reply gives the notification once, so this wakes for each
+         * of them; the loop above takes all that arrived meanwhile. */
+        ( void ) ulTaskNotifyTake( pdTRUE, xTicksToWait );
+    }
+
+    for( x = 0; x < uxCount; x++ )
+    {
+        if( xCompleted[ x ] == pdFALSE )
+        {
+            prvAbandon( pxClient, pxFutures[ x ] );
+            pxFutures[ x ] = ipsaRPC_NO_FUTURE;
+        }
+    }
+
+    return uxDone;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,134 @@
+/*
+ * Request/response calls between tasks.
+ *
+ * A client sends a request to a server's queue and gets back a future, the
+ * correlation id of the request, without waiting for the reply.  It may keep
+ * several calls outstanding, to one or several servers, and collect the
+ * replies later with xIpsaRpcAwait() or uxIpsaRpcAwaitAll(), so a pipeline
+ * of calls costs one round trip instead of one per call.  The server answers
+ * from its own task with uxIpsaRpcServe(), which drains every queued
+ * request in one go.
+ *
+ * Replies are written into a slot of the client, not into the request, and
+ * only if the slot still holds the same correlation id.  A caller that gave
+ * up on a timed out future can therefore reuse the slot at once, a late
+ * reply is counted and dropped.
+ *
+ * Requirements: the client task's notification is used to signal replies,
+ * INCLUDE_xTaskGetCurrentTaskHandle must be 1.
+ */
+
+#ifndef IPSA_RPC_H
+#define IPSA_RPC_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Calls a client may have outstanding at once. */
+#ifndef ipsaRPC_MAX_OUTSTANDING
+    #define ipsaRPC_MAX_OUTSTANDING        ( 8 )
+#endif
+
+/* Correlation id of no call, returned when a call could not be sent. */
+#define ipsaRPC_NO_FUTURE                  ( ( IpsaFuture_t ) 0 )
+
+/* Correlation id: slot index in the low 8 bits, sequence number above. */
+typedef uint32_t IpsaFuture_t;
+
+/*
+ * Server side handler, returns the result of ulOpcode applied to ulArgument.
+ */
+typedef uint32_t (* IpsaRpcHandler_t)( uint32_t ulOpcode,
+                                       uint32_t ulArgument,
+                                       void * pvContext );
+
+typedef struct IPSA_RPC_SLOT
+{
+    IpsaFuture_t xFuture;    /* Call occupying the slot, or ipsaRPC_NO_FUTURE. */
+    uint32_t ulResult;
+    BaseType_t xReady;
+} IpsaRpcSlot_t;
+
+typedef struct IPSA_RPC_CLIENT
+{
+    TaskHandle_t xTask;                                  /* Task that awaits the replies. */
+    IpsaRpcSlot_t xSlots[ ipsaRPC_MAX_OUTSTANDING ];
+    uint32_t ulSequence;
+    uint32_t ulLateReplies;                              /* Replies to abandoned calls. */
+} IpsaRpcClient_t;
+
+typedef struct IPSA_RPC_SERVER
+{
+    QueueHandle_t xRequests;
+    IpsaRpcHandler_t pxHandler;
+    void * pvContext;
+    uint32_t ulServed;
+    uint32_t ulLargestBatch;    /* Most requests drained by one uxIpsaRpcServe(). */
+} IpsaRpcServer_t;
+
+/*
+ * Creates a server whose queue holds uxQueueLength pending requests.
+ */
+BaseType_t xIpsaRpcServerCreate( IpsaRpcServer_t * pxServer,
+                                 UBaseType_t uxQueueLength,
+                                 IpsaRpcHandler_t pxHandler,
+                                 void * pvContext );
+
+/*
+ * Waits up to xTicksToWait for a request, then serves it and every other
+ * request already queued.  Call from the server task.  Returns the number
+ * of requests served.
+ */
+UBaseType_t uxIpsaRpcServe( IpsaRpcServer_t * pxServer,
+                            TickType_t xTicksToWait );
+
+/*
+ * Binds a client to the calling task, which is the only one that may await
+ * its futures.
+ */
+void vIpsaRpcClientInit( IpsaRpcClient_t * pxClient );
+
+/*
+ * Sends ( ulOpcode, ulArgument ) to pxServer, blocking at most
+ * xTicksToWait for room in its queue.  Returns the future of the call, or
+ * ipsaRPC_NO_FUTURE if the client has ipsaRPC_MAX_OUTSTANDING calls pending
+ * or the server queue stayed full.
+ */
+IpsaFuture_t xIpsaRpcCall( IpsaRpcClient_t * pxClient,
+                           IpsaRpcServer_t * pxServer,
+                           uint32_t ulOpcode,
+                           uint32_t ulArgument,
+                           TickType_t xTicksToWait );
+
+/*
+ * pdTRUE and the result in *pulResult if the reply to xFuture has arrived,
+ * in which case the future is consumed.  Never blocks.
+ */
+BaseType_t xIpsaRpcPoll( IpsaRpcClient_t * pxClient,
+                         IpsaFuture_t xFuture,
+                         uint32_t * pulResult );
+
+/*
+ * Waits up to xTicksToWait for the reply to xFuture.  On timeout returns
+ * pdFAIL and abandons the call, its reply will be dropped.
+ */
+BaseType_t xIpsaRpcAwait( IpsaRpcClient_t * pxClient,
+                          IpsaFuture_t xFuture,
+                          uint32_t * pulResult,
+                          TickType_t xTicksToWait );
+
+/*
+ * Waits up to xTicksToWait in total for the replies to uxCount futures.
+ * Returns the number of replies received.  pulResults[ x ] is written for
+ * the futures that completed, the others are abandoned and set to
+ * ipsaRPC_NO_FUTURE in pxFutures.  ipsaRPC_NO_FUTURE entries on input, such
+ * as rejected calls, are not waited for and not counted as replies.
+ */
+UBaseType_t uxIpsaRpcAwaitAll( IpsaRpcClient_t * pxClient,
+                               IpsaFuture_t * pxFutures,
+                               uint32_t * pulResults,
+                               UBaseType_t uxCount,
+                               TickType_t xTicksToWait );
+
+#endif /* IPSA_RPC_H */
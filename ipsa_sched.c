@@ -81,6 +81,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <pthread.h>
 #include <stdbool.h>
 
@@ -93,6 +94,30 @@
 
 /* Local includes. */
 #include "console.h"
+#include "ipsa_analysis.h"
+#include "ipsa_periods.h"
+#include "ipsa_cbs.h"
+#include "ipsa_hsched.h"
+#include "ipsa_temp.h"
+#include "ipsa_index.h"
+#include "ipsa_rcu.h"
+#include "ipsa_sched.h"
+#include "ipsa_sort.h"
+#include "ipsa_dispatch.h"
+#include "ipsa_fmt.h"
+#include "ipsa_pool.h"
+#include "ipsa_rpc.h"
+#include "ipsa_topic.h"
+#include "ipsa_pqueue.h"
+#include "ipsa_mux.h"
+#include "ipsa_deadline.h"
+#include "ipsa_boost.h"
+#include "ipsa_shed.h"
+#include "ipsa_overhead.h"
+#include "ipsa_jitter.h"
+#include "ipsa_drift.h"
+#include "ipsa_critical.h"
+#include "ipsa_contention.h"
 
 /* Priorities at which the tasks are created. */
 #define YOUR_TASK1_PRIORITY                ( tskIDLE_PRIORITY + 1 )
@@ -100,12 +125,234 @@
 #define YOUR_TASK3_PRIORITY                ( tskIDLE_PRIORITY + 3 )
 #define YOUR_TASK4_PRIORITY                ( tskIDLE_PRIORITY + 4 )
 /* The rate at which data is sent to the queue.  The times are converted from
- * milliseconds to ticks using the pdMS_TO_TICKS() macro. */
+ * milliseconds to ticks using the pdMS_TO_TICKS() macro.  The periods
+ * themselves live in ipsa_periods.h, shared with the host side tools. */
 
-#define TASK1_FREQUENCY                    pdMS_TO_TICKS( 4000UL )
-#define TASK2_FREQUENCY                    pdMS_TO_TICKS( 200UL )
-#define TASK3_FREQUENCY                    pdMS_TO_TICKS( 3000UL )
-#define TASK4_FREQUENCY                    pdMS_TO_TICKS( 800UL )
+#define TASK1_FREQUENCY                    pdMS_TO_TICKS( TASK1_PERIOD_MS )
+#define TASK2_FREQUENCY                    pdMS_TO_TICKS( TASK2_PERIOD_MS )
+#define TASK3_FREQUENCY                    pdMS_TO_TICKS( TASK3_PERIOD_MS )
+#define TASK4_FREQUENCY                    pdMS_TO_TICKS( TASK4_PERIOD_MS )
+
+/* Set to 1 to run each job at its preemption threshold instead of its base
+ * priority.  The thresholds are computed at start up by
+ * xIpsaAssignThresholds() from the worst case execution times below, so a
+ * running job is only preempted by tasks that would otherwise miss a
+ * deadline.  A job raised to a threshold shares that priority with the task
+ * whose base priority it is, and time slicing would let that task in, so
+ * FreeRTOSConfig.h must set configUSE_TIME_SLICING to 0. */
+#define ipsaUSE_PREEMPTION_THRESHOLDS      0
+
+/* Worst case execution time estimates, in milliseconds, used by the
+ * schedulability analysis. */
+#define TASK1_WCET_MS                      ( 1UL )
+#define TASK2_WCET_MS                      ( 1UL )
+#define TASK3_WCET_MS                      ( 1UL )
+#define TASK4_WCET_MS                      ( 1UL )
+
+/* Set to 1 to run jobs in non-preemptive chunks: a job can only be preempted
+ * at the preemption points it declares with prvPreemptionPoint().  This takes
+ * precedence over the preemption thresholds.  The longest chunk of each task,
+ * in milliseconds, is given below and checked at start up against the
+ * blocking the higher priority tasks can tolerate. */
+#define ipsaUSE_LIMITED_PREEMPTION         0
+
+#define TASK1_NP_CHUNK_MS                  ( 1UL )
+#define TASK2_NP_CHUNK_MS                  ( 1UL )
+#define TASK3_NP_CHUNK_MS                  ( 1UL )
+#define TASK4_NP_CHUNK_MS                  ( 1UL )
+
+/* Priority at which non-preemptive chunks run.  It sits above every
+ * application and helper task, Task4, the boosted queue receive task and the
+ * urgent pool workers included, so none of them can preempt a chunk or share
+ * its level. */
+#define ipsaNON_PREEMPTIVE_PRIORITY        ( YOUR_TASK4_PRIORITY + 1 )
+
+#if ( ( ( ipsaUSE_PREEMPTION_THRESHOLDS == 1 ) || ( ipsaUSE_LIMITED_PREEMPTION == 1 ) ) && ( configUSE_TIME_SLICING == 1 ) )
+    #error Preemption thresholds and non-preemptive chunks need configUSE_TIME_SLICING 0, tasks of equal priority would take turns.
+#endif
+
+#if ( ( ipsaUSE_LIMITED_PREEMPTION == 1 ) && ( ipsaNON_PREEMPTIVE_PRIORITY >= configTIMER_TASK_PRIORITY ) )
+    #error ipsaNON_PREEMPTIVE_PRIORITY must stay below configTIMER_TASK_PRIORITY, a chunk would hold the timer callbacks off.
+#endif
+
+/* Set to 1 to serve Task4, whose lookups vary in length, from a Constant
+ * Bandwidth Server with the budget below per TASK4_FREQUENCY period.  Its
+ * priority is then managed by ipsa_cbs.c instead of the options above.
+ * vApplicationTickHook() in main.c must call vIpsaCbsTickHook(). */
+#define ipsaUSE_CBS                        0
+#define TASK4_CBS_BUDGET                   pdMS_TO_TICKS( 20UL )
+#define TASK4_CBS_HARD                     pdFALSE
+
+/* Set to 1 to run the tasks as two groups under the hierarchical scheduler
+ * of ipsa_hsched.c: "sensing" (Task2, Task4) with local fixed priorities and
+ * "housekeeping" (Task1, Task3) with local EDF.  Each group's budget per
+ * period is the smallest one its own analysis accepts.  Group members'
+ * priorities are then managed by ipsa_hsched.c, vApplicationTickHook() in
+ * main.c must call vIpsaGroupTickHook(). */
+#define ipsaUSE_GROUPS                     0
+#define ipsaSENSING_PERIOD_MS              ( 50UL )
+#define ipsaHOUSEKEEPING_PERIOD_MS         ( 500UL )
+
+/* Set to 1 to convert Task2's reading through the build time table of
+ * ipsa_temp.c instead of evaluating the floating point formula. */
+#define ipsaUSE_TEMP_LUT                   1
+
+/* Set to 1 to look Task4's keys up through the learned index of
+ * ipsa_index.c instead of a plain binary search.  The model is fitted once
+ * when the task starts, with the error bound and segment budget below. */
+#define ipsaUSE_LEARNED_INDEX              1
+#define TASK4_INDEX_MAX_ERROR              ( 2UL )
+#define TASK4_INDEX_MAX_SEGMENTS           ( 8 )
+
+/* Set to 1 to format Task2's reading with ipsa_fmt.c into a local buffer
+ * instead of printf(), printing the shortest text that reads back as the
+ * same value. */
+#define ipsaUSE_FAST_FORMAT                1
+
+/* Set to 1 to start a pool of worker tasks for ad-hoc jobs, such as
+ * rebuilding Task4's table, instead of creating a task per job.  Urgent,
+ * normal and background jobs run at the priorities in uxPoolPriorities.
+ * Every TASK4_REFRESH_PERIOD a timer hands the pool new, unsorted data for
+ * Task4's table, which background jobs sort TASK4_SORT_STEP_KEYS keys at a
+ * time before publishing it. */
+#define ipsaUSE_WORKER_POOL                1
+#define ipsaPOOL_WORKERS                   ( 2 )
+#define TASK4_REFRESH_PERIOD               pdMS_TO_TICKS( 10000UL )
+#define TASK4_SORT_STEP_KEYS               ( 16U )
+
+/* Set to 1 to let Task1 look keys up in Task4's table through ipsa_rpc.c:
+ * every Task1 job sends a batch of lookups and Task4 answers all of them at
+ * the end of its next job, Task1 waiting at most one Task4 period. */
+#define ipsaUSE_RPC                        0
+#define TASK1_RPC_BATCH                    ( 4 )
+#define ipsaRPC_OP_LOOKUP                  ( 1UL )
+
+/* Set to 1 to publish Task2's readings on xTempTopic.  Task3 reads every
+ * reading in place and reports their mean, Task1 only the latest one; the
+ * ring holds a little more than one Task3 period of readings. */
+#define ipsaUSE_TOPIC_BUS                  1
+#define TEMP_TOPIC_DEPTH                   ( 16 )
+
+/* Set to 1 to replace the FIFO xQueue with a queue that delivers by message
+ * priority, so the timer's urgent message overtakes routine ones. */
+#define ipsaUSE_PRIORITY_QUEUE             1
+
+/* Set to 1 to start the queue receive task.  It waits on the timer messages
+ * and on Task2's readings at once through ipsa_mux.c, handling messages
+ * before readings, and raises an alarm for readings above
+ * TEMP_ALARM_CELSIUS.  Needs configUSE_QUEUE_SETS set to 1. */
+#define ipsaUSE_EVENT_MUX                  1
+#define mainQUEUE_RECEIVE_TASK_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+#define TEMP_ALARM_CELSIUS                 ( 40.0 )
+
+/* Set to 1 to make the consumers of Task2's readings inherit their deadline,
+ * TEMP_READING_DEADLINE after the reading was taken, as soon as Task2
+ * publishes it: the queue receive task through ipsa_deadline.c, Task3
+ * through its EDF group when ipsaUSE_GROUPS is 1. */
+#define ipsaUSE_DEADLINE_INHERITANCE       1
+#define TEMP_READING_DEADLINE              TASK2_FREQUENCY
+
+/* Set to 1 to raise the queue receive task to mainQUEUE_BOOST_PRIORITY while
+ * it falls behind: from the moment the queue holds mainQUEUE_HIGH_WATERMARK
+ * messages until it is empty again.  Each boost that ends is reported with
+ * the boost statistics and the timer's dropped messages.  The demo's own
+ * traffic seldom leaves a second message waiting, so the option is off
+ * unless producers are added. */
+#define ipsaUSE_OCCUPANCY_BOOST            0
+#define mainQUEUE_HIGH_WATERMARK           ( 2U )
+#define mainQUEUE_LOW_WATERMARK            ( 0U )
+#define mainQUEUE_BOOST_PRIORITY           YOUR_TASK4_PRIORITY
+
+/* Set to 1 to have Task2 send mainVALUE_SENT_FROM_TASK as a routine message
+ * every job, and to admit all messages through the xIngress load shedder:
+ * each class may fill the queue in proportion to its utility below, so
+ * routine traffic cannot take the places the timer's messages need.  Task1
+ * reports what was shed.  Needs ipsaUSE_PRIORITY_QUEUE. */
+#define ipsaUSE_LOAD_SHEDDING              1
+#define mainROUTINE_UTILITY                ( 1UL )
+#define mainURGENT_UTILITY                 ( 4UL )
+
+/* Set to 1 to have Task1 report the CPU time taken by context switches, the
+ * tick and the timer daemon next to the task bodies, as measured by
+ * ipsa_overhead.c.  FreeRTOSConfig.h and main.c must install its hooks, see
+ * ipsa_overhead.h. */
+#define ipsaUSE_OVERHEAD_ACCOUNTING        0
+
+/* Set to 1 to calibrate the host before blaming the scheduler.  A
+ * cyclictest style probe measures the clock_nanosleep() wake up latency of
+ * every CPU, JITTER_LOOPS wake ups every JITTER_INTERVAL_US, once before the
+ * scheduler starts and once while it runs, and every job records how late
+ * it was released after the start of its release tick.  Task1 prints the
+ * three side by side.  Start up is delayed by the first measurement.
+ * vApplicationTickHook() in main.c must call vIpsaJitterTick(). */
+#define ipsaUSE_JITTER_CALIBRATION         0
+#define JITTER_INTERVAL_US                 ( 1000UL )
+#define JITTER_LOOPS                       ( 1000UL )
+
+/* Set to 1 to compare the tick count with CLOCK_MONOTONIC every
+ * DRIFT_SAMPLE_PERIOD from a software timer; Task1 reports the lag and the
+ * drift rate.  With ipsaDRIFT_CORRECT also set to 1, ticks lost to a loaded
+ * host are made up with xTaskCatchUpTicks() so the periodic tasks keep their
+ * real world rate. */
+#define ipsaUSE_DRIFT_MONITOR              1
+#define ipsaDRIFT_CORRECT                  0
+#define DRIFT_SAMPLE_PERIOD                pdMS_TO_TICKS( 1000UL )
+
+/* Set to 1 to benchmark the tick rate the demo is built with.  After
+ * TICK_BENCH_DURATION the kernel overhead, the worst p99 and maximum release
+ * jitter of Task1..Task4, their deadline misses and their shortest period
+ * are printed on a single IPSA_TICK_BENCH line and the program exits.
+ * ipsa_tick_sweep.c rebuilds and runs the demo from 100 Hz to 10 kHz with it
+ * and recommends a rate.  Needs ipsaUSE_OVERHEAD_ACCOUNTING, and
+ * vApplicationTickHook() in main.c must call vIpsaJitterTick(). */
+#define ipsaUSE_TICK_BENCH                 0
+#define TICK_BENCH_DURATION                pdMS_TO_TICKS( 20000UL )
+
+/* Set to 1 to have Task1 list the CRITICAL_REPORT_SITES critical sections
+ * and scheduler suspensions, kernel ones included, that kept interrupts
+ * masked or the scheduler suspended the longest, as timed by
+ * ipsa_critical.c.  The build must link it in with the flags given in
+ * ipsa_critical.h. */
+#define ipsaUSE_CRITICAL_PROFILER          0
+#define CRITICAL_REPORT_SITES              ( 8 )
+
+/* Set to 1 to have Task1 list the CONTENTION_REPORT_OBJECTS queues,
+ * semaphores and mutexes its tasks waited on the longest, with who waited on
+ * whom, as followed by ipsa_contention.c.  xQueue and the other objects of
+ * this file are named in the queue registry.  FreeRTOSConfig.h must install
+ * its hooks, see ipsa_contention.h. */
+#define ipsaUSE_CONTENTION_PROFILER        0
+#define CONTENTION_REPORT_OBJECTS          ( 8 )
+
+/* Set to 1 to check every SIMD kernel variant against its scalar version at
+ * start up.  The variants themselves are selected at run time by
+ * ipsa_dispatch.c, set IPSA_ISA=scalar|sse4.2|avx2|avx512 to cap the level. */
+#define ipsaDISPATCH_SELF_TEST             1
+
+#if ( ( ipsaUSE_OCCUPANCY_BOOST == 1 ) && ( ipsaUSE_EVENT_MUX == 0 ) )
+    #error ipsaUSE_OCCUPANCY_BOOST boosts the queue receive task, which needs ipsaUSE_EVENT_MUX.
+#endif
+
+#if ( ( ipsaUSE_LOAD_SHEDDING == 1 ) && ( ipsaUSE_PRIORITY_QUEUE == 0 ) )
+    #error ipsaUSE_LOAD_SHEDDING sheds by message class, which needs ipsaUSE_PRIORITY_QUEUE.
+#endif
+
+#if ( ( ipsaUSE_TICK_BENCH == 1 ) && ( ipsaUSE_OVERHEAD_ACCOUNTING == 0 ) )
+    #error ipsaUSE_TICK_BENCH reports the kernel overhead, which needs ipsaUSE_OVERHEAD_ACCOUNTING.
+#endif
+
+/* Both the calibration and the benchmark time every job against its release. */
+#if ( ( ipsaUSE_JITTER_CALIBRATION == 1 ) || ( ipsaUSE_TICK_BENCH == 1 ) )
+    #define ipsaRECORD_RELEASES            1
+#else
+    #define ipsaRECORD_RELEASES            0
+#endif
+
+#if ( ( ipsaUSE_GROUPS == 1 ) && ( ipsaUSE_CBS == 1 ) )
+    #error ipsaUSE_GROUPS and ipsaUSE_CBS both manage task priorities, enable only one.
+#endif
+
+#define ipsaNUM_TASKS                      ( 4 )
 
 
 /* The number of items the queue can hold at once. */
@@ -116,6 +363,42 @@
 #define mainVALUE_SENT_FROM_TASK           ( 100UL )
 #define mainVALUE_SENT_FROM_TIMER          ( 200UL )
 
+/* Message priorities of the priority queue. */
+#define mainPRIORITY_ROUTINE               ( 0U )
+#define mainPRIORITY_URGENT                ( 1U )
+#define mainPRIORITY_LEVELS                ( 2U )
+
+/* A reading published by Task2. */
+typedef struct TEMP_READING
+{
+    TickType_t xTime;
+    TickType_t xDeadline;    /* Absolute, kept by every stage it goes through. */
+    double dCelsius;
+} TempReading_t;
+
+/* One version of Task4's lookup table.  Versions are immutable once
+ * published through xTask4Rcu. */
+typedef struct TASK4_TABLE
+{
+    const int * piKeys;
+    size_t uxKeys;
+    #if ( ipsaUSE_LEARNED_INDEX == 1 )
+        IpsaLearnedIndex_t xIndex;
+        IpsaSegment_t xSegments[ TASK4_INDEX_MAX_SEGMENTS ];
+        BaseType_t xHaveIndex;
+    #endif
+} Task4Table_t;
+
+#if ( ipsaUSE_WORKER_POOL == 1 )
+    /* A table version being sorted by background jobs of xWorkerPool, the
+     * scratch keys follow the structure. */
+    typedef struct TASK4_INGEST
+    {
+        Task4Table_t * pxTable;
+        IpsaRadixSort_t xSort;
+    } Task4Ingest_t;
+#endif
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -132,25 +415,357 @@ static void Task4( void * pvParameters );
  */
 static void prvQueueSendTimerCallback( TimerHandle_t xTimerHandle );
 
+#if ( ipsaUSE_WORKER_POOL == 1 )
+
+/*
+ * Hands Task4 a new table, standing in for data arriving from the host.
+ */
+    static void prvTask4RefreshCallback( TimerHandle_t xTimerHandle );
+#endif
+
+#if ( ipsaUSE_DRIFT_MONITOR == 1 )
+
+/*
+ * Samples, and optionally corrects, the tick drift.
+ */
+    static void prvDriftTimerCallback( TimerHandle_t xTimerHandle );
+#endif
+
+#if ( ipsaUSE_EVENT_MUX == 1 )
+
+/*
+ * The queue receive task and the handlers of its event sources.
+ */
+    static void prvQueueReceiveTask( void * pvParameters );
+    static void prvOnMessage( QueueSetMemberHandle_t xMember,
+                              void * pvContext );
+    #if ( ipsaUSE_TOPIC_BUS == 1 )
+        static void prvOnReading( QueueSetMemberHandle_t xMember,
+                                  void * pvContext );
+    #endif
+
+/*
+ * Add the event sources to xReceiveMux and start the queue receive task.
+ * Must run before the tasks that signal the sources.
+ */
+    static void prvConfigureReceiver( void );
+#endif
+
+#if ( ( ipsaUSE_TOPIC_BUS == 1 ) && ( ipsaUSE_DEADLINE_INHERITANCE == 1 ) )
+
+/*
+ * Raise the consumers of a reading Task2 just published to its deadline,
+ * so they run by it while the reading waits for them.
+ */
+    static void prvInheritReadingDeadline( TickType_t xDeadline );
+#endif
+
+/*
+ * Compute the preemption thresholds or non-preemptive chunks of the task set
+ * and report which tasks could share a stack.
+ */
+static void prvConfigurePreemption( void );
+
+/*
+ * Select the SIMD kernels for this CPU and optionally check them.
+ */
+static void prvConfigureDispatch( void );
+
+#if ( ipsaUSE_OVERHEAD_ACCOUNTING == 1 )
+
+/*
+ * Print the kernel overhead counters and their histograms.
+ */
+    static void prvReportOverhead( void );
+#endif
+
+#if ( ipsaUSE_CRITICAL_PROFILER == 1 )
+
+/*
+ * Print the longest critical sections and scheduler suspensions.
+ */
+    static void prvReportCritical( void );
+#endif
+
+#if ( ipsaUSE_CONTENTION_PROFILER == 1 )
+
+/*
+ * Name the queues and semaphores of this file in the queue registry, and
+ * print the ones waited on the longest.
+ */
+    static void prvNameObjects( void );
+    static void prvReportContention( void );
+#endif
+
+#if ( ipsaUSE_JITTER_CALIBRATION == 1 )
+
+/*
+ * Measure the host's wake up latency with the port not running yet, then
+ * start the measurement that runs alongside it.
+ */
+    static void prvCalibrateHost( void );
+    static void prvStartLoadedProbe( void );
+
+/*
+ * Print the host and release jitter histograms.
+ */
+    static void prvPrintJitter( const char * pcName,
+                                const IpsaJitterHistogram_t * pxHistogram );
+    static void prvReportJitter( void );
+#endif
+
+#if ( ipsaRECORD_RELEASES == 1 )
+
+/*
+ * Record how late job xTask was released after the start of its release tick
+ * xRelease, and whether it completed after its deadline, the next release.
+ */
+    static void prvRecordRelease( BaseType_t xTask,
+                                  TickType_t xRelease );
+    static void prvRecordCompletion( BaseType_t xTask );
+#endif
+
+#if ( ipsaUSE_TICK_BENCH == 1 )
+
+/*
+ * Prints the IPSA_TICK_BENCH line and ends the run.
+ */
+    static void prvTickBenchCallback( TimerHandle_t xTimerHandle );
+#endif
+
+/*
+ * Create the task groups and enrol the tasks in them.
+ */
+static void prvConfigureGroups( TaskHandle_t * pxHandles );
+
+/*
+ * Called at the start and end of every job, xRelease is the tick the job was
+ * released on.  When preemption thresholds are
+ * in use the job runs at its threshold in between, with limited preemption it
+ * runs non-preemptively except at its preemption points.
+ */
+static UBaseType_t prvRunPriority( BaseType_t xTask );
+static void prvJobBegin( BaseType_t xTask,
+                         TickType_t xRelease );
+static void prvPreemptionPoint( BaseType_t xTask );
+static void prvJobEnd( BaseType_t xTask );
+
+/*
+ * Task4's table is published RCU style: Task4 reads it without locking and
+ * reports a quiescent point at the end of every job, xTask4PublishTable()
+ * swaps in a new sorted key set and frees the old one after that point.
+ * xTask4IngestTable() does the same for unsorted data, radix sorting it
+ * first in the calling task.  prvTask4IngestAsync() only copies the keys
+ * in the calling task and leaves the sort, the index build and the
+ * publication to background jobs of xWorkerPool; prvTask4IngestStep()
+ * advances the sort a bounded number of keys and queues itself again, so
+ * other jobs reach the worker in between.  Any of them may run at the same
+ * time, the publications are serialized by xTask4Writer.
+ */
+static long prvTask4Lookup( const Task4Table_t * pxTable,
+                            int iKey );
+static void prvTask4Prepare( Task4Table_t * pxTable );
+static void prvTask4Free( void * pvTable );
+static Task4Table_t * prvTask4Copy( const int * piKeys,
+                                    size_t uxKeys );
+static BaseType_t prvTask4Finish( Task4Table_t * pxTable,
+                                  BaseType_t xSort );
+static BaseType_t prvTask4Publish( const int * piKeys,
+                                   size_t uxKeys,
+                                   BaseType_t xSort );
+#if ( ipsaUSE_WORKER_POOL == 1 )
+    static BaseType_t prvTask4IngestAsync( const int * piKeys,
+                                           size_t uxKeys );
+    static void prvTask4IngestStep( void * pvIngest );
+#endif
+int binarySearch( const int arr[], int size, int target );
+
 /*-----------------------------------------------------------*/
 
-/* The queue used by both tasks. */
-static QueueHandle_t xQueue = NULL;
+#if ( ipsaUSE_PRIORITY_QUEUE == 1 )
+    /* The queue used by both tasks, urgent messages first. */
+    static IpsaPrioQueue_t xMessages;
+
+    #define mainQUEUE_OCCUPANCY()    uxIpsaPrioQueueMessagesWaiting( &xMessages )
+
+    #if ( ipsaUSE_LOAD_SHEDDING == 1 )
+        /* Admission to xMessages, utilities indexed by message priority. */
+        static IpsaShed_t xIngress;
+        static const uint32_t ulClassUtilities[ mainPRIORITY_LEVELS ] =
+        {
+            mainROUTINE_UTILITY, mainURGENT_UTILITY
+        };
+    #endif
+#else
+    /* The queue used by both tasks. */
+    static QueueHandle_t xQueue = NULL;
+
+    #define mainQUEUE_OCCUPANCY()    uxQueueMessagesWaiting( xQueue )
+#endif
 
 /* A software timer that is started from the tick hook. */
 static TimerHandle_t xTimer = NULL;
 
+#if ( ipsaUSE_DRIFT_MONITOR == 1 )
+    /* Tick count against CLOCK_MONOTONIC, sampled by xDriftTimer. */
+    static IpsaDrift_t xDrift;
+    static TimerHandle_t xDriftTimer = NULL;
+#endif
+
+#if ( ipsaUSE_CBS == 1 )
+    /* Reservation serving Task4. */
+    static IpsaCbsServer_t xTask4Server;
+#endif
+
+#if ( ipsaUSE_WORKER_POOL == 1 )
+    /* Workers for ad-hoc jobs, in place of a task created per job. */
+    static IpsaPool_t xWorkerPool;
+    static const UBaseType_t uxPoolPriorities[ ipsaPOOL_CLASSES ] =
+    {
+        YOUR_TASK4_PRIORITY, YOUR_TASK2_PRIORITY, tskIDLE_PRIORITY + 1
+    };
+
+    /* Feeds Task4 a new table every TASK4_REFRESH_PERIOD. */
+    static TimerHandle_t xRefreshTimer = NULL;
+#endif
+
+#if ( ipsaUSE_TOPIC_BUS == 1 )
+    /* Task2's readings, fanned out to Task1 and Task3. */
+    static IpsaTopic_t xTempTopic;
+#endif
+
+#if ( ipsaUSE_JITTER_CALIBRATION == 1 )
+    /* Host wake up latency without and with the port running. */
+    static IpsaJitterProbe_t xHostIdle;
+    static IpsaJitterProbe_t xHostLoaded;
+    static BaseType_t xLoadedProbeStarted = pdFAIL;
+#endif
+
+#if ( ipsaRECORD_RELEASES == 1 )
+    /* Release jitter of Task1..Task4, against the start of each job's release
+     * tick, and the jobs that completed after their deadline tick. */
+    static IpsaJitterHistogram_t xReleaseJitter[ ipsaNUM_TASKS ];
+    static TickType_t xDeadlineTick[ ipsaNUM_TASKS ];
+    static uint32_t ulJobs[ ipsaNUM_TASKS ];
+    static uint32_t ulDeadlineMisses[ ipsaNUM_TASKS ];
+#endif
+
+#if ( ipsaUSE_EVENT_MUX == 1 )
+    /* Everything the queue receive task waits on. */
+    static IpsaMux_t xReceiveMux;
+
+    #if ( ipsaUSE_OCCUPANCY_BOOST == 1 )
+        static IpsaBoost_t xReceiveBoost;
+        static uint32_t ulTimerDrops = 0;
+    #endif
+
+    #if ( ipsaUSE_TOPIC_BUS == 1 )
+        static BaseType_t xAlarmSubscriber;
+    #endif
+
+    #if ( ipsaUSE_DEADLINE_INHERITANCE == 1 )
+        /* Priorities the queue receive task borrows to meet a deadline. */
+        static IpsaDeadlineBand_t xDeadlineBands[ ipsaNUM_TASKS ];
+        static IpsaDeadlineInheritor_t xReceiveInheritor;
+    #endif
+#endif
+
+#if ( ipsaUSE_RPC == 1 )
+    /* Lookups served by Task4 on behalf of other tasks. */
+    static IpsaRpcServer_t xTask4Lookups;
+
+    static uint32_t prvTask4ServeLookup( uint32_t ulOpcode,
+                                         uint32_t ulArgument,
+                                         void * pvContext );
+#endif
+
+#if ( ipsaUSE_GROUPS == 1 )
+    static IpsaGroup_t xSensingGroup;
+    static IpsaGroup_t xHousekeepingGroup;
+
+    /* Group and member index of Task1..Task4. */
+    static IpsaGroup_t * pxTaskGroup[ ipsaNUM_TASKS ];
+    static BaseType_t xTaskMember[ ipsaNUM_TASKS ];
+#endif
+
+static const int iTask4InitialKeys[] =
+{
+    2, 4, 7, 12, 15, 20, 22, 25, 28, 30,
+    32, 35, 40, 42, 45, 48, 50, 55, 60, 62,
+    65, 70, 75, 80, 82, 85, 88, 90, 92, 95,
+    100, 105, 110, 112, 115, 118, 120, 122, 125, 130,
+    135, 140, 145, 150, 155, 160, 165, 170, 175, 180
+};
+
+static Task4Table_t xTask4InitialTable =
+{
+    iTask4InitialKeys, sizeof( iTask4InitialKeys ) / sizeof( iTask4InitialKeys[ 0 ] ),
+    #if ( ipsaUSE_LEARNED_INDEX == 1 )
+        /* Built by prvTask4Prepare() before the table is published. */
+        { NULL, 0, NULL, 0, 0 }, { { 0, 0, 0.0 } }, pdFALSE
+    #endif
+};
+
+/* Publishes Task4's current table, see xTask4PublishTable(). */
+static IpsaRcu_t xTask4Rcu;
+static const TickType_t xTask4Period = TASK4_FREQUENCY;
+
+/* xTask4Rcu takes a single writer, publications from the calling tasks and
+ * from the pool workers take turns on this mutex. */
+static SemaphoreHandle_t xTask4Writer;
+
+/* Tick every task counts its releases from, shared with the servers and
+ * groups that register the releases on the tick. */
+static TickType_t xReleasePhase;
+
+/* Periods of Task1..Task4 in ticks. */
+static const TickType_t xTaskPeriods[ ipsaNUM_TASKS ] =
+{
+    TASK1_FREQUENCY, TASK2_FREQUENCY, TASK3_FREQUENCY, TASK4_FREQUENCY
+};
+
+/* Milliseconds to ticks rounded up, for budgets that must not shrink. */
+#define mainMS_TO_TICKS_CEIL( xMs )  ( ( TickType_t ) ( ( ( ( uint64_t ) ( xMs ) * configTICK_RATE_HZ ) + 999ULL ) / 1000ULL ) )
+
+/* Ticks to milliseconds, portTICK_PERIOD_MS is 0 above 1 kHz. */
+#define mainTICKS_TO_MS( xTicks )    ( ( uint32_t ) ( ( ( uint64_t ) ( xTicks ) * 1000ULL ) / configTICK_RATE_HZ ) )
+
+/* The task set as seen by the schedulability analysis, indexed Task1..Task4.
+ * Times are in milliseconds. */
+static IpsaTask_t xTaskSet[ ipsaNUM_TASKS ] =
+{
+    { "Task1", 0, mainTICKS_TO_MS( TASK1_FREQUENCY ), 0, TASK1_WCET_MS, YOUR_TASK1_PRIORITY, 0, 0, configMINIMAL_STACK_SIZE, 0, 0 },
+    { "Task2", 0, mainTICKS_TO_MS( TASK2_FREQUENCY ), 0, TASK2_WCET_MS, YOUR_TASK2_PRIORITY, 0, 0, configMINIMAL_STACK_SIZE, 0, 0 },
+    { "Task3", 0, mainTICKS_TO_MS( TASK3_FREQUENCY ), 0, TASK3_WCET_MS, YOUR_TASK3_PRIORITY, 0, 0, configMINIMAL_STACK_SIZE, 0, 0 },
+    { "Task4", 0, mainTICKS_TO_MS( TASK4_FREQUENCY ), 0, TASK4_WCET_MS, YOUR_TASK4_PRIORITY, 0, 0, configMINIMAL_STACK_SIZE, 0, 0 }
+};
+
 /*-----------------------------------------------------------*/
 
 /*** SEE THE COMMENTS AT THE TOP OF THIS FILE ***/
 void ipsa_sched(void)
 {
     const TickType_t xTimerPeriod = 2000UL;
+    TaskHandle_t xHandles[ ipsaNUM_TASKS ] = { NULL };
+    BaseType_t xQueueCreated;
 
     /* Create the queue. */
-    xQueue = xQueueCreate(mainQUEUE_LENGTH, sizeof(uint32_t));
+    #if ( ipsaUSE_PRIORITY_QUEUE == 1 )
+    {
+        xQueueCreated = xIpsaPrioQueueCreate( &xMessages, mainQUEUE_LENGTH, sizeof( uint32_t ), mainPRIORITY_LEVELS );
+
+        #if ( ipsaUSE_LOAD_SHEDDING == 1 )
+            vIpsaShedInit( &xIngress, &xMessages, ulClassUtilities );
+        #endif
+    }
+    #else
+    {
+        xQueue = xQueueCreate(mainQUEUE_LENGTH, sizeof(uint32_t));
+        xQueueCreated = ( xQueue != NULL ) ? pdPASS : pdFAIL;
+    }
+    #endif
 
-    if (xQueue != NULL)
+    if (xQueueCreated == pdPASS)
     {
         /* Start the two tasks as described in the comments at the top of this
          * file. */
@@ -164,24 +779,833 @@ void ipsa_sched(void)
             xTimerStart(xTimer, 0);
         }
 
-        
-        xTaskCreate(Task1, "Task1", configMINIMAL_STACK_SIZE, NULL, YOUR_TASK1_PRIORITY, NULL);
-        xTaskCreate(Task2, "Task2", configMINIMAL_STACK_SIZE, NULL, YOUR_TASK2_PRIORITY, NULL);
-        xTaskCreate(Task3, "Task3", configMINIMAL_STACK_SIZE, NULL, YOUR_TASK3_PRIORITY, NULL);
-        xTaskCreate(Task4, "Task4", configMINIMAL_STACK_SIZE, NULL, YOUR_TASK4_PRIORITY, NULL);
+        #if ( ipsaUSE_DRIFT_MONITOR == 1 )
+        {
+            vIpsaDriftInit( &xDrift );
+            xDriftTimer = xTimerCreate( "Drift", DRIFT_SAMPLE_PERIOD, pdTRUE, NULL, prvDriftTimerCallback );
+
+            if( xDriftTimer != NULL )
+            {
+                xTimerStart( xDriftTimer, 0 );
+            }
+        }
+        #endif
+
+        prvConfigurePreemption();
+        prvConfigureDispatch();
+
+        #if ( ipsaUSE_JITTER_CALIBRATION == 1 )
+            prvCalibrateHost();
+        #endif
+
+        prvTask4Prepare( &xTask4InitialTable );
+        vIpsaRcuInit( &xTask4Rcu, &xTask4InitialTable, prvTask4Free );
+        xTask4Writer = xSemaphoreCreateMutex();
+        configASSERT( xTask4Writer != NULL );
+
+        #if ( ipsaUSE_TOPIC_BUS == 1 )
+        {
+            if( xIpsaTopicCreate( &xTempTopic, sizeof( TempReading_t ), TEMP_TOPIC_DEPTH ) == pdFAIL )
+            {
+                printf( "Temperature topic could not be created\n" );
+            }
+        }
+        #endif
+
+        #if ( ipsaUSE_EVENT_MUX == 1 )
+            prvConfigureReceiver();
+        #endif
+
+        #if ( ipsaUSE_RPC == 1 )
+        {
+            if( xIpsaRpcServerCreate( &xTask4Lookups, TASK1_RPC_BATCH, prvTask4ServeLookup, NULL ) == pdFAIL )
+            {
+                printf( "Task4 lookup server could not be created\n" );
+            }
+        }
+        #endif
+
+        #if ( ipsaUSE_WORKER_POOL == 1 )
+        {
+            if( xIpsaPoolCreate( &xWorkerPool, "Worker", ipsaPOOL_WORKERS, uxPoolPriorities,
+                                 configMINIMAL_STACK_SIZE ) == pdFAIL )
+            {
+                printf( "Worker pool could not be created\n" );
+            }
+            else
+            {
+                xRefreshTimer = xTimerCreate( "Refresh", TASK4_REFRESH_PERIOD, pdTRUE, NULL, prvTask4RefreshCallback );
+
+                if( xRefreshTimer != NULL )
+                {
+                    xTimerStart( xRefreshTimer, 0 );
+                }
+            }
+        }
+        #endif
+
+        #if ( ipsaUSE_CONTENTION_PROFILER == 1 )
+            prvNameObjects();
+        #endif
+
+        xReleasePhase = xTaskGetTickCount();
+
+        xTaskCreate(Task1, "Task1", configMINIMAL_STACK_SIZE, NULL, YOUR_TASK1_PRIORITY, &xHandles[ 0 ]);
+        xTaskCreate(Task2, "Task2", configMINIMAL_STACK_SIZE, NULL, YOUR_TASK2_PRIORITY, &xHandles[ 1 ]);
+        xTaskCreate(Task3, "Task3", configMINIMAL_STACK_SIZE, NULL, YOUR_TASK3_PRIORITY, &xHandles[ 2 ]);
+        xTaskCreate(Task4, "Task4", configMINIMAL_STACK_SIZE, NULL, YOUR_TASK4_PRIORITY, &xHandles[ 3 ]);
+
+        prvConfigureGroups( xHandles );
+
+        #if ( ipsaUSE_CBS == 1 )
+        {
+            if( xIpsaCbsCreate( &xTask4Server, xHandles[ 3 ], TASK4_CBS_BUDGET, TASK4_FREQUENCY, TASK4_CBS_HARD ) == pdFAIL )
+            {
+                printf( "Task4 reservation rejected, bandwidth exhausted\n" );
+            }
+            else
+            {
+                /* Task4 waits at the server's low priority until its budget
+                 * is active, so its releases are registered by the tick hook
+                 * rather than by Task4 once it gets to run. */
+                vIpsaCbsPeriodicReleases( &xTask4Server, xReleasePhase + TASK4_FREQUENCY );
+            }
+        }
+        #endif
+
+        #if ( ipsaRECORD_RELEASES == 1 )
+        {
+            BaseType_t x;
+
+            for( x = 0; x < ipsaNUM_TASKS; x++ )
+            {
+                vIpsaJitterReset( &xReleaseJitter[ x ] );
+            }
+        }
+        #endif
+
+        #if ( ipsaUSE_JITTER_CALIBRATION == 1 )
+            prvStartLoadedProbe();
+        #endif
+
+        #if ( ipsaUSE_TICK_BENCH == 1 )
+        {
+            TimerHandle_t xBenchTimer = xTimerCreate( "Bench", TICK_BENCH_DURATION, pdFALSE, NULL, prvTickBenchCallback );
+
+            if( xBenchTimer != NULL )
+            {
+                xTimerStart( xBenchTimer, 0 );
+            }
+        }
+        #endif
 
         /* Start the tasks and timer running. */
         vTaskStartScheduler();
     }
-
-    /* If all is well, the scheduler will now be running, and the following
-     * line will never be reached.  If the following line does execute, then
-     * there was insufficient FreeRTOS heap memory available for the idle and/or
-     * timer tasks	to be created.  See the memory management section on the
-     * FreeRTOS web site for more details. */
-    for (;;)
+
+    /* If all is well, the scheduler will now be running, and the following
+     * line will never be reached.  If the following line does execute, then
+     * there was insufficient FreeRTOS heap memory available for the idle and/or
+     * timer tasks	to be created.  See the memory management section on the
+     * FreeRTOS web site for more details. */
+    for (;;)
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvConfigurePreemption( void )
+{
+    uint32_t ulGroup[ ipsaNUM_TASKS ];
+    size_t uxGroups, x;
+
+    #if ( ipsaUSE_LIMITED_PREEMPTION == 1 )
+    {
+        const uint32_t ulChunks[ ipsaNUM_TASKS ] =
+        {
+            TASK1_NP_CHUNK_MS, TASK2_NP_CHUNK_MS, TASK3_NP_CHUNK_MS, TASK4_NP_CHUNK_MS
+        };
+
+        for( x = 0; x < ipsaNUM_TASKS; x++ )
+        {
+            xTaskSet[ x ].ulNonPreemptive = ulChunks[ x ];
+        }
+
+        for( x = 0; x < ipsaNUM_TASKS; x++ )
+        {
+            if( ulChunks[ x ] > ulIpsaNonPreemptiveBudget( xTaskSet, ipsaNUM_TASKS, x ) )
+            {
+                printf( "%s: non-preemptive chunk of %lu ms exceeds the %lu ms higher priority tasks tolerate\n",
+                        xTaskSet[ x ].pcName,
+                        ( unsigned long ) ulChunks[ x ],
+                        ( unsigned long ) ulIpsaNonPreemptiveBudget( xTaskSet, ipsaNUM_TASKS, x ) );
+            }
+        }
+    }
+    #elif ( ipsaUSE_PREEMPTION_THRESHOLDS == 1 )
+    {
+        if( xIpsaAssignThresholds( xTaskSet, ipsaNUM_TASKS ) == 0 )
+        {
+            /* Not schedulable even when fully preemptive, so keep the plain
+             * fixed priorities. */
+            printf( "Task set not schedulable, preemption thresholds disabled\n" );
+        }
+    }
+    #endif
+
+    uxGroups = uxIpsaStackGroups( xTaskSet, ipsaNUM_TASKS, ulGroup );
+
+    for( x = 0; x < ipsaNUM_TASKS; x++ )
+    {
+        printf( "%s: priority %lu, runs at %lu, response time %lu ms, stack group %lu\n",
+                xTaskSet[ x ].pcName,
+                ( unsigned long ) xTaskSet[ x ].ulPriority,
+                ( unsigned long ) prvRunPriority( ( BaseType_t ) x ),
+                ( unsigned long ) ulIpsaResponseTime( xTaskSet, ipsaNUM_TASKS, x ),
+                ( unsigned long ) ulGroup[ x ] );
+    }
+
+    printf( "%lu stack group(s), %lu words with shared stacks instead of %lu\n",
+            ( unsigned long ) uxGroups,
+            ( unsigned long ) ulIpsaStackRequirement( xTaskSet, ipsaNUM_TASKS ),
+            ( unsigned long ) ( ipsaNUM_TASKS * configMINIMAL_STACK_SIZE ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvConfigureDispatch( void )
+{
+    eIpsaIsa eLevel = eIpsaDispatchInit();
+
+    printf( "Kernels: %s (CPU supports %s)\n", pcIpsaIsaName( eLevel ), pcIpsaIsaName( eIpsaDispatchDetect() ) );
+
+    #if ( ipsaDISPATCH_SELF_TEST == 1 )
+    {
+        uint32_t ulMismatches = ulIpsaDispatchSelfTest();
+
+        if( ulMismatches != 0U )
+        {
+            printf( "Kernel self test: %lu mismatch(es), falling back to scalar\n", ( unsigned long ) ulMismatches );
+            ( void ) eIpsaDispatchForce( eIpsaIsaScalar );
+        }
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+#if ( ipsaUSE_EVENT_MUX == 1 )
+
+    static void prvConfigureReceiver( void )
+    {
+        BaseType_t xAdded;
+        TaskHandle_t xReceiveTask;
+
+        /* One event per queued message, plus one for the binary semaphore of
+         * the reading subscriber. */
+        if( xIpsaMuxCreate( &xReceiveMux, mainQUEUE_LENGTH + 1U ) == pdFAIL )
+        {
+            printf( "Receive task event set could not be created\n" );
+            return;
+        }
+
+        #if ( ipsaUSE_PRIORITY_QUEUE == 1 )
+            xAdded = xIpsaMuxAddSource( &xReceiveMux, xMessages.xItems, 1, prvOnMessage, NULL );
+        #else
+            xAdded = xIpsaMuxAddSource( &xReceiveMux, xQueue, 1, prvOnMessage, NULL );
+        #endif
+
+        #if ( ipsaUSE_TOPIC_BUS == 1 )
+        {
+            xAlarmSubscriber = xIpsaTopicSubscribe( &xTempTopic, eIpsaTopicDropOldest );
+
+            if( ( xAdded == pdPASS ) && ( xAlarmSubscriber >= 0 ) )
+            {
+                xAdded = xIpsaMuxAddSource( &xReceiveMux, xTempTopic.xSubscribers[ xAlarmSubscriber ].xReady, 0,
+                                            prvOnReading, NULL );
+            }
+            else
+            {
+                xAdded = pdFAIL;
+            }
+        }
+        #endif
+
+        if( xAdded == pdFAIL )
+        {
+            printf( "Receive task sources could not be added\n" );
+            return;
+        }
+
+        if( xTaskCreate( prvQueueReceiveTask, "Rx", configMINIMAL_STACK_SIZE, NULL, mainQUEUE_RECEIVE_TASK_PRIORITY,
+                         &xReceiveTask ) == pdPASS )
+        {
+            #if ( ipsaUSE_DEADLINE_INHERITANCE == 1 )
+                vIpsaDeadlineInit( &xReceiveInheritor, xReceiveTask, xDeadlineBands,
+                                   uxIpsaDeadlineBands( xTaskSet, ipsaNUM_TASKS, xDeadlineBands ) );
+            #endif
+
+            #if ( ipsaUSE_OCCUPANCY_BOOST == 1 )
+                vIpsaBoostInit( &xReceiveBoost, xReceiveTask, mainQUEUE_BOOST_PRIORITY,
+                                mainQUEUE_HIGH_WATERMARK, mainQUEUE_LOW_WATERMARK );
+            #endif
+        }
+    }
+
+#endif /* ipsaUSE_EVENT_MUX */
+/*-----------------------------------------------------------*/
+
+#if ( ipsaUSE_OVERHEAD_ACCOUNTING == 1 )
+
+    static void prvReportOverhead( void )
+    {
+        IpsaOverheadCounter_t xCounters[ eIpsaOverheadClasses ];
+        uint64_t ullElapsed = ullIpsaOverheadSnapshot( xCounters );
+        UBaseType_t x, uxBucket;
+
+        if( ullElapsed == 0U )
+        {
+            return;
+        }
+
+        for( x = 0; x < eIpsaOverheadClasses; x++ )
+        {
+            printf( "%-6s %8lu events %10lu us %5.2f%%", pcIpsaOverheadName( ( eIpsaOverheadClass ) x ),
+                    ( unsigned long ) xCounters[ x ].ulEvents,
+                    ( unsigned long ) ( xCounters[ x ].ullNanoseconds / 1000U ),
+                    100.0 * ( double ) xCounters[ x ].ullNanoseconds / ( double ) ullElapsed );
+
+            /* Non empty buckets as <upper bound in ns>:<count>. */
+            for( uxBucket = 0; uxBucket < ipsaOVERHEAD_BUCKETS; uxBucket++ )
+            {
+                if( xCounters[ x ].ulHistogram[ uxBucket ] != 0U )
+                {
+                    printf( " <%llu:%lu", 1ULL << ( uxBucket + 1U + ipsaOVERHEAD_SHIFT ),
+                            ( unsigned long ) xCounters[ x ].ulHistogram[ uxBucket ] );
+                }
+            }
+
+            printf( "\n" );
+        }
+    }
+
+#endif /* ipsaUSE_OVERHEAD_ACCOUNTING */
+/*-----------------------------------------------------------*/
+
+#if ( ipsaUSE_CRITICAL_PROFILER == 1 )
+
+    static void prvReportCritical( void )
+    {
+        static IpsaCriticalSite_t xSites[ CRITICAL_REPORT_SITES ];
+        char cName[ 96 ];
+        uint32_t ulDropped;
+        UBaseType_t uxSites, x, uxBucket;
+
+        uxSites = uxIpsaCriticalSnapshot( xSites, CRITICAL_REPORT_SITES, &ulDropped );
+
+        for( x = 0; x < uxSites; x++ )
+        {
+            vIpsaCriticalSiteName( xSites[ x ].pvSite, cName, sizeof( cName ) );
+            printf( "%-8s %-48s %8lu times max %8lu avg %6lu ns",
+                    ( xSites[ x ].eKind == eIpsaCriticalSection ) ? "critical" : "suspend", cName,
+                    ( unsigned long ) xSites[ x ].ulCount, ( unsigned long ) xSites[ x ].ullMax,
+                    ( unsigned long ) ( xSites[ x ].ullTotal / xSites[ x ].ulCount ) );
+
+            /* Non empty buckets as <upper bound in ns>:<count>. */
+            for( uxBucket = 0; uxBucket < ipsaCRITICAL_BUCKETS; uxBucket++ )
+            {
+                if( xSites[ x ].ulHistogram[ uxBucket ] != 0U )
+                {
+                    printf( " <%llu:%lu", 1ULL << ( uxBucket + 1U + ipsaCRITICAL_SHIFT ),
+                            ( unsigned long ) xSites[ x ].ulHistogram[ uxBucket ] );
+                }
+            }
+
+            printf( "\n" );
+        }
+
+        if( ulDropped != 0U )
+        {
+            printf( "%lu sections not recorded, raise ipsaCRITICAL_MAX_SITES\n", ( unsigned long ) ulDropped );
+        }
+    }
+
+#endif /* ipsaUSE_CRITICAL_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( ipsaUSE_CONTENTION_PROFILER == 1 )
+
+    static void prvNameObjects( void )
+    {
+        #if ( ipsaUSE_PRIORITY_QUEUE == 1 )
+        {
+            vQueueAddToRegistry( xMessages.xItems, "Messages" );
+            vQueueAddToRegistry( xMessages.xSpaces, "Spaces" );
+        }
+        #else
+        {
+            vQueueAddToRegistry( xQueue, "xQueue" );
+        }
+        #endif
+
+        #if ( ipsaUSE_EVENT_MUX == 1 )
+        {
+            if( xReceiveMux.xSet != NULL )
+            {
+                vQueueAddToRegistry( xReceiveMux.xSet, "Rx set" );
+            }
+        }
+        #endif
+
+        #if ( ipsaUSE_WORKER_POOL == 1 )
+        {
+            if( xWorkerPool.xWork != NULL )
+            {
+                vQueueAddToRegistry( xWorkerPool.xWork, "Pool work" );
+            }
+        }
+        #endif
+
+        #if ( ipsaUSE_RPC == 1 )
+        {
+            if( xTask4Lookups.xRequests != NULL )
+            {
+                vQueueAddToRegistry( xTask4Lookups.xRequests, "Lookups" );
+            }
+        }
+        #endif
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvReportContention( void )
+    {
+        static IpsaContentionObject_t xObjects[ CONTENTION_REPORT_OBJECTS ];
+        static IpsaContentionEdge_t xEdges[ ipsaCONTENTION_MAX_EDGES ];
+        static const char * const pcSides[ eIpsaContentionSides ] = { "take", "give" };
+        const IpsaContentionCounters_t * pxSide;
+        char cName[ 24 ];
+        const char * pcName;
+        size_t uxObjects, uxEdges, x, y, uxSide;
+
+        uxObjects = uxIpsaContentionObjects( xObjects, CONTENTION_REPORT_OBJECTS );
+        uxEdges = uxIpsaContentionEdges( xEdges, ipsaCONTENTION_MAX_EDGES );
+
+        for( x = 0; x < uxObjects; x++ )
+        {
+            pcName = pcQueueGetName( ( QueueHandle_t ) xObjects[ x ].pvObject );
+
+            if( pcName == NULL )
+            {
+                snprintf( cName, sizeof( cName ), "%p", xObjects[ x ].pvObject );
+                pcName = cName;
+            }
+
+            printf( "%-16s %-9s", pcName, pcIpsaContentionType( xObjects[ x ].ucType ) );
+
+            for( uxSide = 0; uxSide < eIpsaContentionSides; uxSide++ )
+            {
+                pxSide = &xObjects[ x ].xSides[ uxSide ];
+                printf( "  %s %lu/%lu contended %lu timed out, wait %lu us max %lu us", pcSides[ uxSide ],
+                        ( unsigned long ) pxSide->ulContended, ( unsigned long ) pxSide->ulOperations,
+                        ( unsigned long ) pxSide->ulTimeouts, ( unsigned long ) ( pxSide->ullWait / 1000U ),
+                        ( unsigned long ) ( pxSide->ullMaxWait / 1000U ) );
+            }
+
+            printf( "\n" );
+
+            /* Who waited on whom, longest first. */
+            for( y = 0; y < uxEdges; y++ )
+            {
+                if( xEdges[ y ].pvObject == xObjects[ x ].pvObject )
+                {
+                    printf( "    %s waited %lu times %lu us to %s, on %s\n", xEdges[ y ].cWaiter,
+                            ( unsigned long ) xEdges[ y ].ulWaits, ( unsigned long ) ( xEdges[ y ].ullWait / 1000U ),
+                            pcSides[ xEdges[ y ].eSide ], xEdges[ y ].cCulprit );
+                }
+            }
+        }
+    }
+
+#endif /* ipsaUSE_CONTENTION_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( ipsaUSE_JITTER_CALIBRATION == 1 )
+
+    static void prvCalibrateHost( void )
+    {
+        printf( "Calibrating host wake up latency...\n" );
+
+        if( xIpsaJitterProbeStart( &xHostIdle, JITTER_INTERVAL_US, JITTER_LOOPS ) == pdPASS )
+        {
+            vIpsaJitterProbeJoin( &xHostIdle );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvStartLoadedProbe( void )
+    {
+        xLoadedProbeStarted = xIpsaJitterProbeStart( &xHostLoaded, JITTER_INTERVAL_US, JITTER_LOOPS );
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvPrintJitter( const char * pcName,
+                                const IpsaJitterHistogram_t * pxHistogram )
+    {
+        if( pxHistogram->ulSamples == 0U )
+        {
+            return;
+        }
+
+        printf( "%-12s %6lu samples  min %8lu  avg %8lu  p99 %8lu  max %8lu ns\n", pcName,
+                ( unsigned long ) pxHistogram->ulSamples,
+                ( unsigned long ) pxHistogram->ullMin,
+                ( unsigned long ) ( pxHistogram->ullSum / pxHistogram->ulSamples ),
+                ( unsigned long ) ullIpsaJitterPercentile( pxHistogram, 99 ),
+                ( unsigned long ) pxHistogram->ullMax );
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvReportJitter( void )
+    {
+        static BaseType_t xHostReported = pdFALSE;
+        char cName[ 16 ];
+        UBaseType_t x;
+
+        /* The host figures are printed once, when the probe running next to
+         * the port has finished. */
+        if( ( xHostReported == pdFALSE ) && ( xLoadedProbeStarted == pdPASS ) && ( xIpsaJitterProbeDone( &xHostLoaded ) != pdFALSE ) )
+        {
+            vIpsaJitterProbeJoin( &xHostLoaded );
+            xHostReported = pdTRUE;
+
+            printf( "Host wake up latency, %s threads:\n", ( xHostLoaded.xRealTime != pdFALSE ) ? "SCHED_FIFO" : "normal" );
+
+            for( x = 0; x < xHostIdle.uxCpus; x++ )
+            {
+                snprintf( cName, sizeof( cName ), "cpu%lu idle", ( unsigned long ) x );
+                prvPrintJitter( cName, &xHostIdle.xCpus[ x ] );
+            }
+
+            for( x = 0; x < xHostLoaded.uxCpus; x++ )
+            {
+                snprintf( cName, sizeof( cName ), "cpu%lu port", ( unsigned long ) x );
+                prvPrintJitter( cName, &xHostLoaded.xCpus[ x ] );
+            }
+        }
+
+        /* Read while the tasks keep recording, good enough for a report. */
+        for( x = 0; x < ipsaNUM_TASKS; x++ )
+        {
+            snprintf( cName, sizeof( cName ), "%s release", xTaskSet[ x ].pcName );
+            prvPrintJitter( cName, &xReleaseJitter[ x ] );
+        }
+    }
+
+#endif /* ipsaUSE_JITTER_CALIBRATION */
+/*-----------------------------------------------------------*/
+
+#if ( ipsaRECORD_RELEASES == 1 )
+
+    static void prvRecordRelease( BaseType_t xTask,
+                                  TickType_t xRelease )
+    {
+        uint64_t ullNow = ullIpsaJitterNow();
+        uint64_t ullRelease = ullIpsaJitterTickTime( xRelease );
+
+        /* Each job is measured from its own tick, so a late or lost tick is
+         * charged to the jobs it released and not carried over. */
+        if( ullRelease != 0U )
+        {
+            vIpsaJitterRecord( &xReleaseJitter[ xTask ], ( ullNow > ullRelease ) ? ( ullNow - ullRelease ) : 0U );
+        }
+
+        xDeadlineTick[ xTask ] = xRelease + xTaskPeriods[ xTask ];
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvRecordCompletion( BaseType_t xTask )
+    {
+        /* Deadlines are implicit, a job is late once the tick of the next
+         * release has started. */
+        if( ( TickType_t ) ( xTaskGetTickCount() - xDeadlineTick[ xTask ] ) <= ( portMAX_DELAY / 2U ) )
+        {
+            ulDeadlineMisses[ xTask ]++;
+        }
+
+        ulJobs[ xTask ]++;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* ipsaRECORD_RELEASES */
+
+#if ( ipsaUSE_TICK_BENCH == 1 )
+
+    static void prvTickBenchCallback( TimerHandle_t xTimerHandle )
+    {
+        IpsaOverheadCounter_t xCounters[ eIpsaOverheadClasses ];
+        uint64_t ullElapsed = ullIpsaOverheadSnapshot( xCounters );
+        uint64_t ullKernel, ullP99 = 0, ullMax = 0;
+        uint32_t ulMisses = 0, ulJobsDone = 0;
+        TickType_t xShortest = portMAX_DELAY;
+        BaseType_t x;
+
+        ( void ) xTimerHandle;
+
+        ullKernel = xCounters[ eIpsaOverheadSwitch ].ullNanoseconds + xCounters[ eIpsaOverheadTick ].ullNanoseconds +
+                    xCounters[ eIpsaOverheadTimer ].ullNanoseconds;
+
+        /* Worst task for the jitter, all tasks for the misses. */
+        for( x = 0; x < ipsaNUM_TASKS; x++ )
+        {
+            if( xReleaseJitter[ x ].ulSamples != 0U )
+            {
+                if( ullIpsaJitterPercentile( &xReleaseJitter[ x ], 99 ) > ullP99 )
+                {
+                    ullP99 = ullIpsaJitterPercentile( &xReleaseJitter[ x ], 99 );
+                }
+
+                if( xReleaseJitter[ x ].ullMax > ullMax )
+                {
+                    ullMax = xReleaseJitter[ x ].ullMax;
+                }
+            }
+
+            ulMisses += ulDeadlineMisses[ x ];
+            ulJobsDone += ulJobs[ x ];
+
+            if( xTaskPeriods[ x ] < xShortest )
+            {
+                xShortest = xTaskPeriods[ x ];
+            }
+        }
+
+        /* The shortest period goes out too, the sweep tool sizes its jitter
+         * budget from it. */
+        printf( "IPSA_TICK_BENCH rate=%lu overhead_ppm=%lu jitter_p99_ns=%llu jitter_max_ns=%llu misses=%lu jobs=%lu period_ns=%llu\n",
+                ( unsigned long ) configTICK_RATE_HZ,
+                ( unsigned long ) ( ( ullElapsed != 0U ) ? ( ( ullKernel * 1000000ULL ) / ullElapsed ) : 0U ),
+                ( unsigned long long ) ullP99, ( unsigned long long ) ullMax,
+                ( unsigned long ) ulMisses, ( unsigned long ) ulJobsDone,
+                ( unsigned long long ) ( ( ( uint64_t ) xShortest * 1000000000ULL ) / configTICK_RATE_HZ ) );
+        fflush( stdout );
+
+        exit( 0 );
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* ipsaUSE_TICK_BENCH */
+
+static void prvConfigureGroups( TaskHandle_t * pxHandles )
+{
+    #if ( ipsaUSE_GROUPS == 1 )
+    {
+        /* Task indices of each group, local priority order follows the
+         * original fixed priorities. */
+        const size_t uxSensing[] = { 1, 3 };
+        const size_t uxHousekeeping[] = { 0, 2 };
+        IpsaTask_t xSubset[ 2 ];
+        uint32_t ulSensingBudget, ulHousekeepingBudget;
+        size_t x;
+
+        for( x = 0; x < 2; x++ )
+        {
+            xSubset[ x ] = xTaskSet[ uxSensing[ x ] ];
+        }
+
+        ulSensingBudget = ulIpsaGroupMinBudget( xSubset, 2, ipsaLOCAL_FP, ipsaSENSING_PERIOD_MS );
+
+        for( x = 0; x < 2; x++ )
+        {
+            xSubset[ x ] = xTaskSet[ uxHousekeeping[ x ] ];
+        }
+
+        ulHousekeepingBudget = ulIpsaGroupMinBudget( xSubset, 2, ipsaLOCAL_EDF, ipsaHOUSEKEEPING_PERIOD_MS );
+
+        printf( "sensing: %lu/%lu ms, housekeeping: %lu/%lu ms\n",
+                ( unsigned long ) ulSensingBudget, ( unsigned long ) ipsaSENSING_PERIOD_MS,
+                ( unsigned long ) ulHousekeepingBudget, ( unsigned long ) ipsaHOUSEKEEPING_PERIOD_MS );
+
+        /* Budgets are rounded up to whole ticks. */
+        if( ( ulSensingBudget == ipsaUNSCHEDULABLE ) || ( ulHousekeepingBudget == ipsaUNSCHEDULABLE ) ||
+            ( xIpsaGroupCreate( &xSensingGroup, "sensing", ipsaLOCAL_FP,
+                                mainMS_TO_TICKS_CEIL( ulSensingBudget ),
+                                pdMS_TO_TICKS( ipsaSENSING_PERIOD_MS ) ) == pdFAIL ) ||
+            ( xIpsaGroupCreate( &xHousekeepingGroup, "housekeeping", ipsaLOCAL_EDF,
+                                mainMS_TO_TICKS_CEIL( ulHousekeepingBudget ),
+                                pdMS_TO_TICKS( ipsaHOUSEKEEPING_PERIOD_MS ) ) == pdFAIL ) )
+        {
+            printf( "Task groups rejected, keeping flat fixed priorities\n" );
+            return;
+        }
+
+        for( x = 0; x < 2; x++ )
+        {
+            pxTaskGroup[ uxSensing[ x ] ] = &xSensingGroup;
+            xTaskMember[ uxSensing[ x ] ] = xIpsaGroupAddTask( &xSensingGroup, pxHandles[ uxSensing[ x ] ],
+                                                               ( UBaseType_t ) xTaskSet[ uxSensing[ x ] ].ulPriority,
+                                                               pdMS_TO_TICKS( xTaskSet[ uxSensing[ x ] ].ulPeriod ) );
+
+            pxTaskGroup[ uxHousekeeping[ x ] ] = &xHousekeepingGroup;
+            xTaskMember[ uxHousekeeping[ x ] ] = xIpsaGroupAddTask( &xHousekeepingGroup, pxHandles[ uxHousekeeping[ x ] ],
+                                                                    ( UBaseType_t ) xTaskSet[ uxHousekeeping[ x ] ].ulPriority,
+                                                                    pdMS_TO_TICKS( xTaskSet[ uxHousekeeping[ x ] ].ulPeriod ) );
+        }
+
+        /* The members may wait in a low band when released, so the tick
+         * hook registers their releases at the ticks the tasks wake up. */
+        for( x = 0; x < ipsaNUM_TASKS; x++ )
+        {
+            vIpsaGroupPeriodicReleases( pxTaskGroup[ x ], xTaskMember[ x ],
+                                        xReleasePhase + xTaskPeriods[ x ], xTaskPeriods[ x ] );
+        }
+    }
+    #else
+    {
+        ( void ) pxHandles;
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvRunPriority( BaseType_t xTask )
+{
+    #if ( ipsaUSE_LIMITED_PREEMPTION == 1 )
+    {
+        ( void ) xTask;
+        return ipsaNON_PREEMPTIVE_PRIORITY;
+    }
+    #else
+    {
+        if( xTaskSet[ xTask ].ulThreshold > xTaskSet[ xTask ].ulPriority )
+        {
+            return ( UBaseType_t ) xTaskSet[ xTask ].ulThreshold;
+        }
+
+        return ( UBaseType_t ) xTaskSet[ xTask ].ulPriority;
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvJobBegin( BaseType_t xTask,
+                         TickType_t xRelease )
+{
+    #if ( ipsaRECORD_RELEASES == 1 )
+        prvRecordRelease( xTask, xRelease );
+    #else
+        ( void ) xRelease;
+    #endif
+
+    #if ( ipsaUSE_GROUPS == 1 )
+    {
+        /* The tick hook has registered the release. */
+        if( pxTaskGroup[ xTask ] != NULL )
+        {
+            return;
+        }
+    }
+    #endif
+
+    #if ( ipsaUSE_CBS == 1 )
+    {
+        /* The tick hook has registered the arrival at the release. */
+        if( xTask == 3 )
+        {
+            return;
+        }
+    }
+    #endif
+
+    #if ( ( ipsaUSE_PREEMPTION_THRESHOLDS == 1 ) || ( ipsaUSE_LIMITED_PREEMPTION == 1 ) )
+    {
+        /* The job has been dispatched at its base priority, from now on only
+         * tasks above the threshold may preempt it. */
+        if( prvRunPriority( xTask ) > xTaskSet[ xTask ].ulPriority )
+        {
+            vTaskPrioritySet( NULL, prvRunPriority( xTask ) );
+        }
+    }
+    #else
+    {
+        ( void ) xTask;
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvPreemptionPoint( BaseType_t xTask )
+{
+    #if ( ipsaUSE_LIMITED_PREEMPTION == 1 )
+    {
+        #if ( ipsaUSE_CBS == 1 )
+        {
+            if( xTask == 3 )
+            {
+                return;
+            }
+        }
+        #elif ( ipsaUSE_GROUPS == 1 )
+        {
+            if( pxTaskGroup[ xTask ] != NULL )
+            {
+                return;
+            }
+        }
+        #endif
+
+        /* Dropping back to the base priority switches to any higher priority
+         * task released during the chunk, the next chunk then starts once
+         * they are done. */
+        if( prvRunPriority( xTask ) > xTaskSet[ xTask ].ulPriority )
+        {
+            vTaskPrioritySet( NULL, ( UBaseType_t ) xTaskSet[ xTask ].ulPriority );
+            vTaskPrioritySet( NULL, prvRunPriority( xTask ) );
+        }
+    }
+    #else
+    {
+        ( void ) xTask;
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvJobEnd( BaseType_t xTask )
+{
+    #if ( ipsaRECORD_RELEASES == 1 )
+        prvRecordCompletion( xTask );
+    #endif
+
+    #if ( ipsaUSE_GROUPS == 1 )
+    {
+        if( pxTaskGroup[ xTask ] != NULL )
+        {
+            vIpsaGroupJobEnd( pxTaskGroup[ xTask ], xTaskMember[ xTask ] );
+            return;
+        }
+    }
+    #endif
+
+    #if ( ipsaUSE_CBS == 1 )
+    {
+        if( xTask == 3 )
+        {
+            vIpsaCbsJobComplete( &xTask4Server );
+            return;
+        }
+    }
+    #endif
+
+    #if ( ( ipsaUSE_PREEMPTION_THRESHOLDS == 1 ) || ( ipsaUSE_LIMITED_PREEMPTION == 1 ) )
+    {
+        if( prvRunPriority( xTask ) > xTaskSet[ xTask ].ulPriority )
+        {
+            vTaskPrioritySet( NULL, ( UBaseType_t ) xTaskSet[ xTask ].ulPriority );
+        }
+    }
+    #else
     {
+        ( void ) xTask;
     }
+    #endif
 }
 /*-----------------------------------------------------------*/
 void Task1(void * pvParameters)
@@ -189,12 +1613,95 @@ void Task1(void * pvParameters)
     TickType_t xNextWakeTime;
     const TickType_t xBlockTime = TASK1_FREQUENCY;
 
-    xNextWakeTime = xTaskGetTickCount();
+    #if ( ipsaUSE_TOPIC_BUS == 1 )
+        BaseType_t xTempSubscriber = xIpsaTopicSubscribe( &xTempTopic, eIpsaTopicLatestOnly );
+
+        configASSERT( xTempSubscriber >= 0 );
+    #endif
+
+    #if ( ipsaUSE_RPC == 1 )
+        static IpsaRpcClient_t xClient;
+        IpsaFuture_t xFutures[ TASK1_RPC_BATCH ];
+        uint32_t ulPositions[ TASK1_RPC_BATCH ];
+        UBaseType_t x, uxAnswered;
+
+        vIpsaRpcClientInit( &xClient );
+    #endif
+
+    xNextWakeTime = xReleasePhase;
 
     for (;;) {
         vTaskDelayUntil(&xNextWakeTime, xBlockTime);
+        prvJobBegin( 0, xNextWakeTime );
 
         printf("Working ! :D\n");
+
+        #if ( ipsaUSE_OVERHEAD_ACCOUNTING == 1 )
+            prvReportOverhead();
+        #endif
+
+        #if ( ipsaUSE_CRITICAL_PROFILER == 1 )
+            prvReportCritical();
+        #endif
+
+        #if ( ipsaUSE_CONTENTION_PROFILER == 1 )
+            prvReportContention();
+        #endif
+
+        #if ( ipsaUSE_JITTER_CALIBRATION == 1 )
+            prvReportJitter();
+        #endif
+
+        #if ( ipsaUSE_DRIFT_MONITOR == 1 )
+        {
+            printf( "Tick drift: %ld ppm, lag %ld ticks (max %ld), %lu correction(s) adding %lu ticks\n",
+                    ( long ) xDrift.lPpm, ( long ) xDrift.lLag, ( long ) xDrift.lMaxLag,
+                    ( unsigned long ) xDrift.ulCorrections, ( unsigned long ) xDrift.ulTicksAdded );
+        }
+        #endif
+
+        #if ( ipsaUSE_LOAD_SHEDDING == 1 )
+        {
+            printf( "Ingress: routine %lu/%lu shed, urgent %lu/%lu shed, value %lu kept %lu shed\n",
+                    ( unsigned long ) xIngress.xClasses[ mainPRIORITY_ROUTINE ].ulShed,
+                    ( unsigned long ) xIngress.xClasses[ mainPRIORITY_ROUTINE ].ulOffered,
+                    ( unsigned long ) xIngress.xClasses[ mainPRIORITY_URGENT ].ulShed,
+                    ( unsigned long ) xIngress.xClasses[ mainPRIORITY_URGENT ].ulOffered,
+                    ( unsigned long ) xIngress.ullValueAdmitted, ( unsigned long ) xIngress.ullValueShed );
+        }
+        #endif
+
+        #if ( ipsaUSE_TOPIC_BUS == 1 )
+        {
+            const TempReading_t * pxReading = ( const TempReading_t * ) pvIpsaTopicPeek( &xTempTopic, xTempSubscriber );
+
+            if( pxReading != NULL )
+            {
+                TempReading_t xLatest = *pxReading;
+
+                if( xIpsaTopicRelease( &xTempTopic, xTempSubscriber ) == pdPASS )
+                {
+                    printf( "Task1: latest reading %.2f at tick %lu\n", xLatest.dCelsius, ( unsigned long ) xLatest.xTime );
+                }
+            }
+        }
+        #endif
+
+        #if ( ipsaUSE_RPC == 1 )
+        {
+            /* Pipelined: all requests go out before the first reply is
+             * awaited, Task4 answers the whole batch in one activation. */
+            for( x = 0; x < TASK1_RPC_BATCH; x++ )
+            {
+                xFutures[ x ] = xIpsaRpcCall( &xClient, &xTask4Lookups, ipsaRPC_OP_LOOKUP, ( uint32_t ) ( x * 10U ), 0 );
+            }
+
+            uxAnswered = uxIpsaRpcAwaitAll( &xClient, xFutures, ulPositions, TASK1_RPC_BATCH, TASK4_FREQUENCY );
+            printf( "Task1: %lu of %d lookups answered\n", ( unsigned long ) uxAnswered, TASK1_RPC_BATCH );
+        }
+        #endif
+
+        prvJobEnd( 0 );
     }
 }
 
@@ -206,13 +1713,61 @@ void Task2(void * pvParameters)
     const TickType_t xBlockTime = TASK2_FREQUENCY;
     double fahrenheit = 100;
 
-    xNextWakeTime = xTaskGetTickCount();
+    xNextWakeTime = xReleasePhase;
 
     for (;;) {
         vTaskDelayUntil(&xNextWakeTime, xBlockTime);
+        prvJobBegin( 1, xNextWakeTime );
 
-        double celsius = (5.0 / 9.0) * (fahrenheit - 32.0);
-        printf("Temp: %f\n", celsius);
+        #if ( ipsaUSE_TEMP_LUT == 1 )
+            float celsius = fIpsaTempCelsius( ( uint16_t ) fahrenheit );
+        #else
+            double celsius = (5.0 / 9.0) * (fahrenheit - 32.0);
+        #endif
+
+        #if ( ipsaUSE_FAST_FORMAT == 1 )
+        {
+            char cLine[ 16 + ipsaFMT_MAX_NUMBER ];
+            #if ( ipsaUSE_TEMP_LUT == 1 )
+                IpsaFmtArg_t xArgs[] = { ipsaFMT_FLOAT( celsius ) };
+            #else
+                IpsaFmtArg_t xArgs[] = { ipsaFMT_DOUBLE( celsius ) };
+            #endif
+
+            uxIpsaFmt( cLine, sizeof( cLine ), "Temp: {}\n", xArgs, 1 );
+            fputs( cLine, stdout );
+        }
+        #else
+            printf("Temp: %f\n", celsius);
+        #endif
+
+        #if ( ipsaUSE_TOPIC_BUS == 1 )
+        {
+            TickType_t xNow = xTaskGetTickCount();
+            TempReading_t xReading = { xNow, xNow + TEMP_READING_DEADLINE, celsius };
+
+            /* Only lossy subscribers, so this never waits. */
+            ( void ) xIpsaTopicPublish( &xTempTopic, &xReading, 0 );
+
+            #if ( ipsaUSE_DEADLINE_INHERITANCE == 1 )
+                prvInheritReadingDeadline( xReading.xDeadline );
+            #endif
+        }
+        #endif
+
+        #if ( ipsaUSE_LOAD_SHEDDING == 1 )
+        {
+            const uint32_t ulValueToSend = mainVALUE_SENT_FROM_TASK;
+
+            ( void ) xIpsaShedOffer( &xIngress, &ulValueToSend, mainPRIORITY_ROUTINE );
+
+            #if ( ipsaUSE_OCCUPANCY_BOOST == 1 )
+                ( void ) xIpsaBoostUpdate( &xReceiveBoost, mainQUEUE_OCCUPANCY() );
+            #endif
+        }
+        #endif
+
+        prvJobEnd( 1 );
     }
 }
 /*-----------------------------------------------------------*/
@@ -222,21 +1777,100 @@ void Task3(void * pvParameters)
     TickType_t xNextWakeTime;
     const TickType_t xBlockTime = TASK3_FREQUENCY;
 
-    xNextWakeTime = xTaskGetTickCount();
+    #if ( ipsaUSE_TOPIC_BUS == 1 )
+        BaseType_t xSubscriber = xIpsaTopicSubscribe( &xTempTopic, eIpsaTopicDropOldest );
+        const TempReading_t * pxReading;
+
+        configASSERT( xSubscriber >= 0 );
+    #endif
+
+    xNextWakeTime = xReleasePhase;
 
     for (;;) {
         vTaskDelayUntil(&xNextWakeTime, xBlockTime);
+        prvJobBegin( 2, xNextWakeTime );
 
         long int num1 = 3287648234862934629;
         long int num2 = 2346723849729472340;
         long int result = num1 * num2;
+        prvPreemptionPoint( 2 );
         printf("Task 3 executed\n");
+
+        #if ( ipsaUSE_TOPIC_BUS == 1 )
+        {
+            double dSum = 0.0;
+            uint32_t ulCount = 0;
+
+            /* Read in place, a reading overwritten meanwhile is skipped. */
+            while( ( pxReading = ( const TempReading_t * ) pvIpsaTopicPeek( &xTempTopic, xSubscriber ) ) != NULL )
+            {
+                double dCelsius = pxReading->dCelsius;
+
+                #if ( ( ipsaUSE_DEADLINE_INHERITANCE == 1 ) && ( ipsaUSE_GROUPS == 1 ) )
+                {
+                    /* Task2 only moves the deadline of a job already
+                     * released, readings published before this job was
+                     * released are inherited here. */
+                    if( pxTaskGroup[ 2 ] != NULL )
+                    {
+                        vIpsaGroupInheritDeadline( pxTaskGroup[ 2 ], xTaskMember[ 2 ], pxReading->xDeadline );
+                    }
+                }
+                #endif
+
+                if( xIpsaTopicRelease( &xTempTopic, xSubscriber ) == pdPASS )
+                {
+                    dSum += dCelsius;
+                    ulCount++;
+                }
+            }
+
+            if( ulCount > 0U )
+            {
+                printf( "Task3: mean of %lu readings %.2f\n", ( unsigned long ) ulCount, dSum / ( double ) ulCount );
+            }
+        }
+        #endif
+
+        prvJobEnd( 2 );
     }
 }
 
 
 /*-----------------------------------------------------------*/
 
+#if ( ( ipsaUSE_TOPIC_BUS == 1 ) && ( ipsaUSE_DEADLINE_INHERITANCE == 1 ) )
+
+    static void prvInheritReadingDeadline( TickType_t xDeadline )
+    {
+        #if ( ipsaUSE_EVENT_MUX == 1 )
+        {
+            /* Bound to the queue receive task once it was created. */
+            if( xReceiveInheritor.xTask != NULL )
+            {
+                vIpsaDeadlineInherit( &xReceiveInheritor, xDeadline );
+            }
+        }
+        #endif
+
+        #if ( ipsaUSE_GROUPS == 1 )
+        {
+            /* Moves the deadline of a Task3 job already released. */
+            if( pxTaskGroup[ 2 ] != NULL )
+            {
+                vIpsaGroupInheritDeadline( pxTaskGroup[ 2 ], xTaskMember[ 2 ], xDeadline );
+            }
+        }
+        #endif
+
+        #if ( ( ipsaUSE_EVENT_MUX == 0 ) && ( ipsaUSE_GROUPS == 0 ) )
+            ( void ) xDeadline;
+        #endif
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* ipsaUSE_DEADLINE_INHERITANCE */
+
 int binarySearch(const int arr[], int size, int target) {
     int left = 0;
     int right = size - 1;
@@ -245,37 +1879,315 @@ int binarySearch(const int arr[], int size, int target) {
         int mid = left + (right - left) / 2;
 
         if (arr[mid] == target) {
-            return 0;  
+            return mid;
         } else if (arr[mid] < target) {
             left = mid + 1;
         } else {
             right = mid - 1;
         }
     }
+
+    return -1;
+}
+
+/*
+ * Looks iKey up in a Task4 table version with the configured search.
+ */
+static long prvTask4Lookup( const Task4Table_t * pxTable,
+                            int iKey )
+{
+    #if ( ipsaUSE_LEARNED_INDEX == 1 )
+    {
+        if( pxTable->xHaveIndex != 0 )
+        {
+            return lIpsaLearnedIndexFind( &pxTable->xIndex, iKey );
+        }
+    }
+    #endif
+
+    return binarySearch( pxTable->piKeys, ( int ) pxTable->uxKeys, iKey );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Fills in the search structures of a table version before it is published.
+ */
+static void prvTask4Prepare( Task4Table_t * pxTable )
+{
+    #if ( ipsaUSE_LEARNED_INDEX == 1 )
+    {
+        pxTable->xHaveIndex = xIpsaLearnedIndexBuild( &pxTable->xIndex, pxTable->piKeys, pxTable->uxKeys,
+                                                      TASK4_INDEX_MAX_ERROR, pxTable->xSegments,
+                                                      TASK4_INDEX_MAX_SEGMENTS );
+    }
+    #else
+    {
+        ( void ) pxTable;
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvTask4Free( void * pvTable )
+{
+    /* The version built into the image is never freed. */
+    if( pvTable != ( void * ) &xTask4InitialTable )
+    {
+        vPortFree( pvTable );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Copies the keys into a new, unpublished table version.
+ */
+static Task4Table_t * prvTask4Copy( const int * piKeys,
+                                    size_t uxKeys )
+{
+    Task4Table_t * pxTable;
+    int * piCopy;
+    size_t x;
+
+    pxTable = ( Task4Table_t * ) pvPortMalloc( sizeof( Task4Table_t ) + ( uxKeys * sizeof( int ) ) );
+
+    if( pxTable != NULL )
+    {
+        piCopy = ( int * ) ( pxTable + 1 );
+
+        for( x = 0; x < uxKeys; x++ )
+        {
+            piCopy[ x ] = piKeys[ x ];
+        }
+
+        pxTable->piKeys = piCopy;
+        pxTable->uxKeys = uxKeys;
+    }
+
+    return pxTable;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Sorts a copied table version when xSort is pdTRUE, builds its search
+ * structures and publishes it.  The version is freed on failure.
+ */
+static BaseType_t prvTask4Finish( Task4Table_t * pxTable,
+                                  BaseType_t xSort )
+{
+    IpsaRadixSort_t * pxWork;
+    int * piTemp;
+
+    /* The new version is built completely before readers can see it.  The
+     * sort state is too large for a worker's stack, it comes from the heap
+     * with the scratch keys. */
+    if( xSort != pdFALSE )
+    {
+        pxWork = ( IpsaRadixSort_t * ) pvPortMalloc( sizeof( IpsaRadixSort_t ) + ( pxTable->uxKeys * sizeof( int ) ) );
+
+        if( pxWork == NULL )
+        {
+            vPortFree( pxTable );
+            return pdFAIL;
+        }
+
+        piTemp = ( int * ) ( pxWork + 1 );
+        vIpsaRadixSortInt( ( int * ) ( pxTable + 1 ), piTemp, pxTable->uxKeys, pxWork );
+        vPortFree( pxWork );
+    }
+
+    prvTask4Prepare( pxTable );
+
+    /* Versions are sorted and prepared concurrently, only their publication
+     * is serialized. */
+    ( void ) xSemaphoreTake( xTask4Writer, portMAX_DELAY );
+
+    /* Too many old versions still in their grace period: wait for Task4 to
+     * pass a quiescent point, only the writers block. */
+    while( xIpsaRcuPublish( &xTask4Rcu, pxTable ) == pdFAIL )
+    {
+        vIpsaRcuSynchronize( &xTask4Rcu, xTask4Period );
+    }
+
+    ( void ) xSemaphoreGive( xTask4Writer );
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvTask4Publish( const int * piKeys,
+                                   size_t uxKeys,
+                                   BaseType_t xSort )
+{
+    Task4Table_t * pxTable = prvTask4Copy( piKeys, uxKeys );
+
+    if( pxTable == NULL )
+    {
+        return pdFAIL;
+    }
+
+    return prvTask4Finish( pxTable, xSort );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xTask4PublishTable( const int * piKeys,
+                               size_t uxKeys )
+{
+    return prvTask4Publish( piKeys, uxKeys, pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xTask4IngestTable( const int * piKeys,
+                              size_t uxKeys )
+{
+    return prvTask4Publish( piKeys, uxKeys, pdTRUE );
 }
+/*-----------------------------------------------------------*/
+
+#if ( ipsaUSE_WORKER_POOL == 1 )
+
+    static BaseType_t prvTask4IngestAsync( const int * piKeys,
+                                           size_t uxKeys )
+    {
+        Task4Table_t * pxTable = prvTask4Copy( piKeys, uxKeys );
+        Task4Ingest_t * pxIngest;
+
+        if( pxTable == NULL )
+        {
+            return pdFAIL;
+        }
+
+        /* The sort state is too large for a worker's stack, it lives in the
+         * heap with the scratch keys until the last step. */
+        pxIngest = ( Task4Ingest_t * ) pvPortMalloc( sizeof( Task4Ingest_t ) + ( uxKeys * sizeof( int ) ) );
+
+        if( pxIngest == NULL )
+        {
+            vPortFree( pxTable );
+            return pdFAIL;
+        }
+
+        pxIngest->pxTable = pxTable;
+        vIpsaRadixFlipInt( ( int * ) ( pxTable + 1 ), uxKeys );
+        vIpsaRadixInit( &pxIngest->xSort, pxTable + 1, pxIngest + 1, uxKeys, sizeof( int ), 1U );
+
+        if( xIpsaPoolSubmit( &xWorkerPool, prvTask4IngestStep, pxIngest, eIpsaPoolBackground ) == ipsaPOOL_NO_HANDLE )
+        {
+            vPortFree( pxIngest );
+            vPortFree( pxTable );
+            return pdFAIL;
+        }
+
+        return pdPASS;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvTask4IngestStep( void * pvIngest )
+    {
+        Task4Ingest_t * pxIngest = ( Task4Ingest_t * ) pvIngest;
+        Task4Table_t * pxTable = pxIngest->pxTable;
+
+        while( xIpsaRadixStep( &pxIngest->xSort, TASK4_SORT_STEP_KEYS ) == 0 )
+        {
+            /* Queued behind the jobs submitted since this step started.  With
+             * every slot in use, carry on in this job instead. */
+            if( xIpsaPoolSubmit( &xWorkerPool, prvTask4IngestStep, pxIngest, eIpsaPoolBackground ) != ipsaPOOL_NO_HANDLE )
+            {
+                return;
+            }
+        }
+
+        vIpsaRadixFlipInt( ( int * ) ( pxTable + 1 ), pxTable->uxKeys );
+        vPortFree( pxIngest );
+
+        ( void ) prvTask4Finish( pxTable, pdFALSE );
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvTask4RefreshCallback( TimerHandle_t xTimerHandle )
+    {
+        static int iKeys[ sizeof( iTask4InitialKeys ) / sizeof( iTask4InitialKeys[ 0 ] ) ];
+        const size_t uxKeys = sizeof( iKeys ) / sizeof( iKeys[ 0 ] );
+        size_t x;
+
+        ( void ) xTimerHandle;
+
+        /* Task4's keys out of order, 7 being prime to their count.  Only
+         * the copy is made here, in the timer daemon. */
+        for( x = 0; x < uxKeys; x++ )
+        {
+            iKeys[ x ] = iTask4InitialKeys[ ( x * 7U ) % uxKeys ];
+        }
+
+        if( prvTask4IngestAsync( iKeys, uxKeys ) == pdFAIL )
+        {
+            printf( "Task4 table refresh rejected\n" );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* ipsaUSE_WORKER_POOL */
+
+#if ( ipsaUSE_RPC == 1 )
+
+    /*
+     * Runs in Task4 before its quiescent point, so the current table version
+     * stays valid.  Returns the key's position or UINT32_MAX.
+     */
+    static uint32_t prvTask4ServeLookup( uint32_t ulOpcode,
+                                         uint32_t ulArgument,
+                                         void * pvContext )
+    {
+        const Task4Table_t * pxTable = ( const Task4Table_t * ) pvIpsaRcuDereference( &xTask4Rcu );
+        long lPosition = -1;
+
+        ( void ) pvContext;
+
+        if( ulOpcode == ipsaRPC_OP_LOOKUP )
+        {
+            lPosition = prvTask4Lookup( pxTable, ( int ) ulArgument );
+        }
+
+        return ( lPosition < 0 ) ? UINT32_MAX : ( uint32_t ) lPosition;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* ipsaUSE_RPC */
 
 void Task4(void *pvParameters)
 {
     TickType_t xNextWakeTime;
     const TickType_t xBlockTime = TASK4_FREQUENCY;
+    const Task4Table_t * pxTable;
+    BaseType_t xReader = xIpsaRcuRegisterReader( &xTask4Rcu );
 
-    xNextWakeTime = xTaskGetTickCount();
+    configASSERT( xReader >= 0 );
 
-    int elements[50] = {2, 4, 7, 12, 15, 20, 22, 25, 28, 30,
-                                32, 35, 40, 42, 45, 48, 50, 55, 60, 62,
-                                65, 70, 75, 80, 82, 85, 88, 90, 92, 95,
-                                100, 105, 110, 112, 115, 118, 120, 122, 125, 130,
-                                135, 140, 145, 150, 155, 160, 165, 170, 175, 180};
+    xNextWakeTime = xReleasePhase;
 
     int targetElement = 15;
 
     for (;;)
     {
         vTaskDelayUntil(&xNextWakeTime, xBlockTime);
+        prvJobBegin( 3, xNextWakeTime );
+
+        /* Whatever version is current now stays valid until the quiescent
+         * point below, even if the table is replaced meanwhile. */
+        pxTable = ( const Task4Table_t * ) pvIpsaRcuDereference( &xTask4Rcu );
+        ( void ) prvTask4Lookup( pxTable, targetElement );
+        pxTable = NULL;
+
+        #if ( ipsaUSE_RPC == 1 )
+            /* Answer the lookups other tasks queued since the last job. */
+            ( void ) uxIpsaRpcServe( &xTask4Lookups, 0 );
+        #endif
+
+        vIpsaRcuQuiescent( &xTask4Rcu, xReader );
 
-        binarySearch(elements, 50, targetElement);
-       
+        prvPreemptionPoint( 3 );
         printf("Task 4 executed\n");
+
+        prvJobEnd( 3 );
     }
 }
 
@@ -285,6 +2197,7 @@ void Task4(void *pvParameters)
 static void prvQueueSendTimerCallback( TimerHandle_t xTimerHandle )
 {
     const uint32_t ulValueToSend = mainVALUE_SENT_FROM_TIMER;
+    BaseType_t xSent;
 
     /* This is the software timer callback function.  The software timer has a
      * period of two seconds and is reset each time a key is pressed.  This
@@ -297,8 +2210,155 @@ static void prvQueueSendTimerCallback( TimerHandle_t xTimerHandle )
     /* Send to the queue - causing the queue receive task to unblock and
      * write out a message.  This function is called from the timer/daemon task, so
      * must not block.  Hence the block time is set to 0. */
-    xQueueSend( xQueue, &ulValueToSend, 0U );
+    #if ( ipsaUSE_PRIORITY_QUEUE == 1 )
+    {
+        #if ( ipsaUSE_LOAD_SHEDDING == 1 )
+            xSent = xIpsaShedOffer( &xIngress, &ulValueToSend, mainPRIORITY_URGENT );
+        #else
+            xSent = xIpsaPrioQueueSend( &xMessages, &ulValueToSend, mainPRIORITY_URGENT, 0U );
+        #endif
+    }
+    #else
+    {
+        xSent = xQueueSend( xQueue, &ulValueToSend, 0U );
+    }
+    #endif
+
+    #if ( ipsaUSE_OCCUPANCY_BOOST == 1 )
+    {
+        if( xSent != pdPASS )
+        {
+            ulTimerDrops++;
+        }
+
+        ( void ) xIpsaBoostUpdate( &xReceiveBoost, mainQUEUE_OCCUPANCY() );
+    }
+    #else
+        ( void ) xSent;
+    #endif
 }
 /*-----------------------------------------------------------*/
 
+#if ( ipsaUSE_DRIFT_MONITOR == 1 )
+
+    static void prvDriftTimerCallback( TimerHandle_t xTimerHandle )
+    {
+        ( void ) xTimerHandle;
+
+        /* Runs in the timer daemon, where catching up ticks is allowed. */
+        ( void ) lIpsaDriftSample( &xDrift, ( ipsaDRIFT_CORRECT == 1 ) ? pdTRUE : pdFALSE );
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* ipsaUSE_DRIFT_MONITOR */
+
+#if ( ipsaUSE_EVENT_MUX == 1 )
+
+    static void prvQueueReceiveTask( void * pvParameters )
+    {
+        ( void ) pvParameters;
+
+        for( ;; )
+        {
+            /* Blocks on every source at once, no polling. */
+            ( void ) uxIpsaMuxWait( &xReceiveMux, portMAX_DELAY );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvOnMessage( QueueSetMemberHandle_t xMember,
+                              void * pvContext )
+    {
+        uint32_t ulReceivedValue;
+
+        ( void ) pvContext;
+
+        #if ( ipsaUSE_PRIORITY_QUEUE == 1 )
+            ( void ) xMember;
+
+            if( xIpsaPrioQueueReceive( &xMessages, &ulReceivedValue, NULL, 0 ) != pdPASS )
+            {
+                return;
+            }
+        #else
+            if( xQueueReceive( ( QueueHandle_t ) xMember, &ulReceivedValue, 0 ) != pdPASS )
+            {
+                return;
+            }
+        #endif
+
+        if( ulReceivedValue == mainVALUE_SENT_FROM_TIMER )
+        {
+            printf( "Message received from software timer\n" );
+        }
+        else if( ulReceivedValue == mainVALUE_SENT_FROM_TASK )
+        {
+            printf( "Message received from task\n" );
+        }
+        else
+        {
+            printf( "Unexpected message\n" );
+        }
+
+        #if ( ipsaUSE_OCCUPANCY_BOOST == 1 )
+        {
+            if( xIpsaBoostUpdate( &xReceiveBoost, mainQUEUE_OCCUPANCY() ) != pdFALSE )
+            {
+                printf( "Rx caught up: %lu boost(s), %lu ticks boosted, peak %lu, %lu timer drop(s)\n",
+                        ( unsigned long ) xReceiveBoost.ulBoosts, ( unsigned long ) xReceiveBoost.ulBoostedTicks,
+                        ( unsigned long ) xReceiveBoost.uxPeak, ( unsigned long ) ulTimerDrops );
+            }
+        }
+        #endif
+    }
+/*-----------------------------------------------------------*/
+
+    #if ( ipsaUSE_TOPIC_BUS == 1 )
+
+        static void prvOnReading( QueueSetMemberHandle_t xMember,
+                                  void * pvContext )
+        {
+            const TempReading_t * pxReading;
+            TempReading_t xReading;
+
+            ( void ) pvContext;
+
+            /* The event is the subscriber's wake up, every unread reading is
+             * handled with it. */
+            ( void ) xSemaphoreTake( ( SemaphoreHandle_t ) xMember, 0 );
+
+            for( ;; )
+            {
+                while( ( pxReading = ( const TempReading_t * ) pvIpsaTopicPeek( &xTempTopic, xAlarmSubscriber ) ) != NULL )
+                {
+                    xReading = *pxReading;
+
+                    if( ( xIpsaTopicRelease( &xTempTopic, xAlarmSubscriber ) == pdPASS ) &&
+                        ( xReading.dCelsius > TEMP_ALARM_CELSIUS ) )
+                    {
+                        printf( "Alarm: %.2f at tick %lu\n", xReading.dCelsius, ( unsigned long ) xReading.xTime );
+                    }
+                }
+
+                #if ( ipsaUSE_DEADLINE_INHERITANCE == 1 )
+                {
+                    /* Task2 raised this task as it published.  A reading
+                     * published since the last look keeps it raised until
+                     * that reading is handled too. */
+                    if( xIpsaDeadlineRestore( &xReceiveInheritor ) == pdFALSE )
+                    {
+                        continue;
+                    }
+                }
+                #endif
+
+                break;
+            }
+        }
+
+    #endif /* ipsaUSE_TOPIC_BUS */
+/*-----------------------------------------------------------*/
+
+#endif /* ipsaUSE_EVENT_MUX */
+
 
@@ -0,0 +1,35 @@
+/*
+ * Entry points of the ipsa_sched demo, for main.c and for the code that
+ * feeds Task4 new data from the host.
+ *
+ * ipsa_sched() creates the queue, timers and tasks and starts the scheduler.
+ * Once it runs, any task may replace Task4's lookup table; Task4 keeps
+ * looking keys up in the version it holds until its next quiescent point.
+ */
+
+#ifndef IPSA_SCHED_H
+#define IPSA_SCHED_H
+
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+
+void ipsa_sched( void );
+
+/*
+ * Publishes a copy of uxKeys sorted keys as Task4's table.  Blocks the
+ * caller only while too many old versions are still in their grace period.
+ * Returns pdFAIL if the copy could not be allocated.
+ */
+BaseType_t xTask4PublishTable( const int * piKeys,
+                               size_t uxKeys );
+
+/*
+ * As xTask4PublishTable() for unsorted keys, radix sorted in the calling
+ * task before the publication.  Returns pdFAIL if the copy or the sort state
+ * could not be allocated.
+ */
+BaseType_t xTask4IngestTable( const int * piKeys,
+                              size_t uxKeys );
+
+#endif /* IPSA_SCHED_H */
@@ -0,0 +1,84 @@
+/*
+ * Utility based load shedding, see ipsa_shed.h.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "ipsa_shed.h"
+
+/*-----------------------------------------------------------*/
+
+void vIpsaShedInit( IpsaShed_t * pxShed,
+                    IpsaPrioQueue_t * pxQueue,
+                    const uint32_t * pulUtilities )
+{
+    IpsaShedClass_t * pxClass;
+    uint32_t ulHighest = 0;
+    UBaseType_t x;
+
+    for( x = 0; x < pxQueue->uxLevels; x++ )
+    {
+        if( pulUtilities[ x ] > ulHighest )
+        {
+            ulHighest = pulUtilities[ x ];
+        }
+    }
+
+    configASSERT( ulHighest != 0U );
+
+    pxShed->pxQueue = pxQueue;
+    pxShed->ullValueAdmitted = 0;
+    pxShed->ullValueShed = 0;
+
+    for( x = 0; x < pxQueue->uxLevels; x++ )
+    {
+        pxClass = &pxShed->xClasses[ x ];
+        pxClass->ulUtility = pulUtilities[ x ];
+        pxClass->uxLimit = ( UBaseType_t ) ( ( ( uint64_t ) pxQueue->uxLength * pulUtilities[ x ] + ulHighest - 1U ) / ulHighest );
+        pxClass->ulOffered = 0;
+        pxClass->ulShed = 0;
+
+        if( pxClass->uxLimit == 0U )
+        {
+            pxClass->uxLimit = 1;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaShedOffer( IpsaShed_t * pxShed,
+                           const void * pvItem,
+                           UBaseType_t uxClass )
+{
+    IpsaShedClass_t * pxClass = &pxShed->xClasses[ uxClass ];
+    BaseType_t xQueued = pdFAIL;
+
+    /* A concurrent sender may pass the limit by one message, the queue's own
+     * capacity still bounds the backlog. */
+    if( uxIpsaPrioQueueMessagesWaiting( pxShed->pxQueue ) < pxClass->uxLimit )
+    {
+        xQueued = xIpsaPrioQueueSend( pxShed->pxQueue, pvItem, uxClass, 0 );
+    }
+
+    taskENTER_CRITICAL();
+    {
+        pxClass->ulOffered++;
+
+        if( xQueued == pdPASS )
+        {
+            pxShed->ullValueAdmitted += pxClass->ulUtility;
+        }
+        else
+        {
+            pxClass->ulShed++;
+            pxShed->ullValueShed += pxClass->ulUtility;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xQueued;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,55 @@
+/*
+ * Utility based load shedding in front of a priority queue.
+ *
+ * Sending with a zero timeout sheds whatever arrives once the queue is full,
+ * valuable or not.  Here every message class, one per priority level of the
+ * queue, has a utility, and a class may only fill the queue up to its share
+ * of the capacity: uxLength * utility / highest utility, at least one
+ * message.  Under sustained overload the low value classes are refused
+ * first and the remaining places are kept for the classes worth most, so
+ * the value of what gets processed stays as high as the capacity allows.
+ *
+ * Decisions never wait and never remove queued messages, so the queue's
+ * items semaphore stays usable as a queue set member.
+ */
+
+#ifndef IPSA_SHED_H
+#define IPSA_SHED_H
+
+#include "FreeRTOS.h"
+
+#include "ipsa_pqueue.h"
+
+typedef struct IPSA_SHED_CLASS
+{
+    uint32_t ulUtility;
+    UBaseType_t uxLimit;       /* Backlog from which the class is shed. */
+    uint32_t ulOffered;
+    uint32_t ulShed;
+} IpsaShedClass_t;
+
+typedef struct IPSA_SHED
+{
+    IpsaPrioQueue_t * pxQueue;
+    IpsaShedClass_t xClasses[ ipsaPQUEUE_MAX_LEVELS ];
+    uint64_t ullValueAdmitted;
+    uint64_t ullValueShed;
+} IpsaShed_t;
+
+/*
+ * Puts pxShed in front of pxQueue.  pulUtilities holds the utility of each
+ * of its priority levels, the highest must be non zero.
+ */
+void vIpsaShedInit( IpsaShed_t * pxShed,
+                    IpsaPrioQueue_t * pxQueue,
+                    const uint32_t * pulUtilities );
+
+/*
+ * Queues a copy of pvItem as a message of class uxClass if the backlog
+ * allows it.  Returns pdPASS if it was queued, pdFAIL if it was shed.
+ */
+BaseType_t xIpsaShedOffer( IpsaShed_t * pxShed,
+                           const void * pvItem,
+                           UBaseType_t uxClass );
+
+#endif /* IPSA_SHED_H */
@@ -0,0 +1,332 @@
+/*
+ * LSD radix sort for 32 and 64-bit keys, see ipsa_sort.h.
+ */
+
+#include <string.h>
+
+#include "ipsa_sort.h"
+
+/*-----------------------------------------------------------*/
+
+/* First key of part uxPart. */
+static size_t prvPartStart( const IpsaRadixSort_t * pxSort,
+                            size_t uxPart )
+{
+    return ( size_t ) ( ( ( uint64_t ) pxSort->uxCount * uxPart ) / pxSort->uxParts );
+}
+/*-----------------------------------------------------------*/
+
+/* Adds keys x .. uxEnd - 1 to the histogram of part uxPart. */
+static void prvCountRange( IpsaRadixSort_t * pxSort,
+                           size_t uxPart,
+                           size_t x,
+                           size_t uxEnd )
+{
+    size_t * puxHistogram = pxSort->uxHistogram[ uxPart ];
+    unsigned uShift = pxSort->uShift;
+
+    if( pxSort->uxKeyBytes == sizeof( uint32_t ) )
+    {
+        const uint32_t * pulFrom = ( const uint32_t * ) pxSort->pvFrom;
+
+        for( ; x < uxEnd; x++ )
+        {
+            puxHistogram[ ( pulFrom[ x ] >> uShift ) & ( ipsaRADIX_BUCKETS - 1U ) ]++;
+        }
+    }
+    else
+    {
+        const uint64_t * pullFrom = ( const uint64_t * ) pxSort->pvFrom;
+
+        for( ; x < uxEnd; x++ )
+        {
+            puxHistogram[ ( pullFrom[ x ] >> uShift ) & ( ipsaRADIX_BUCKETS - 1U ) ]++;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Moves keys x .. uxEnd - 1 of part uxPart to their place. */
+static void prvScatterRange( IpsaRadixSort_t * pxSort,
+                             size_t uxPart,
+                             size_t x,
+                             size_t uxEnd )
+{
+    size_t * puxOffsets = pxSort->uxHistogram[ uxPart ];
+    unsigned uShift = pxSort->uShift;
+
+    if( pxSort->uxKeyBytes == sizeof( uint32_t ) )
+    {
+        const uint32_t * pulFrom = ( const uint32_t * ) pxSort->pvFrom;
+        uint32_t * pulTo = ( uint32_t * ) pxSort->pvTo;
+
+        for( ; x < uxEnd; x++ )
+        {
+            pulTo[ puxOffsets[ ( pulFrom[ x ] >> uShift ) & ( ipsaRADIX_BUCKETS - 1U ) ]++ ] = pulFrom[ x ];
+        }
+    }
+    else
+    {
+        const uint64_t * pullFrom = ( const uint64_t * ) pxSort->pvFrom;
+        uint64_t * pullTo = ( uint64_t * ) pxSort->pvTo;
+
+        for( ; x < uxEnd; x++ )
+        {
+            pullTo[ puxOffsets[ ( pullFrom[ x ] >> uShift ) & ( ipsaRADIX_BUCKETS - 1U ) ]++ ] = pullFrom[ x ];
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaRadixInit( IpsaRadixSort_t * pxSort,
+                     void * pvKeys,
+                     void * pvTemp,
+                     size_t uxCount,
+                     size_t uxKeyBytes,
+                     size_t uxParts )
+{
+    if( uxParts == 0U )
+    {
+        uxParts = 1U;
+    }
+    else if( uxParts > ipsaRADIX_MAX_PARTS )
+    {
+        uxParts = ipsaRADIX_MAX_PARTS;
+    }
+
+    pxSort->pvKeys = pvKeys;
+    pxSort->pvTemp = pvTemp;
+    pxSort->uxCount = uxCount;
+    pxSort->uxKeyBytes = uxKeyBytes;
+    pxSort->uxParts = uxParts;
+    pxSort->pvFrom = pvKeys;
+    pxSort->pvTo = pvTemp;
+    pxSort->uShift = 0U;
+    pxSort->ePhase = ( uxCount > 1U ) ? eIpsaRadixCount : eIpsaRadixDone;
+    pxSort->uxNextPart = 0U;
+    pxSort->uxNextKey = 0U;
+    pxSort->xSkipPass = 0;
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaRadixCount( IpsaRadixSort_t * pxSort,
+                      size_t uxPart )
+{
+    memset( pxSort->uxHistogram[ uxPart ], 0, sizeof( pxSort->uxHistogram[ 0 ] ) );
+    prvCountRange( pxSort, uxPart, prvPartStart( pxSort, uxPart ), prvPartStart( pxSort, uxPart + 1U ) );
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaRadixOffsets( IpsaRadixSort_t * pxSort )
+{
+    size_t uxOffset = 0U, uxBucketTotal, uxCount;
+    size_t uxBucket, uxPart;
+
+    pxSort->xSkipPass = 0;
+
+    /* Bucket major, part minor order keeps the sort stable. */
+    for( uxBucket = 0U; uxBucket < ipsaRADIX_BUCKETS; uxBucket++ )
+    {
+        uxBucketTotal = 0U;
+
+        for( uxPart = 0U; uxPart < pxSort->uxParts; uxPart++ )
+        {
+            uxCount = pxSort->uxHistogram[ uxPart ][ uxBucket ];
+            pxSort->uxHistogram[ uxPart ][ uxBucket ] = uxOffset;
+            uxOffset += uxCount;
+            uxBucketTotal += uxCount;
+        }
+
+        /* A digit shared by every key would only copy the keys across. */
+        if( uxBucketTotal == pxSort->uxCount )
+        {
+            pxSort->xSkipPass = 1;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaRadixScatter( IpsaRadixSort_t * pxSort,
+                        size_t uxPart )
+{
+    if( pxSort->xSkipPass != 0 )
+    {
+        return;
+    }
+
+    prvScatterRange( pxSort, uxPart, prvPartStart( pxSort, uxPart ), prvPartStart( pxSort, uxPart + 1U ) );
+}
+/*-----------------------------------------------------------*/
+
+int xIpsaRadixNextPass( IpsaRadixSort_t * pxSort )
+{
+    void * pvSwap;
+
+    if( pxSort->ePhase == eIpsaRadixDone )
+    {
+        return 0;
+    }
+
+    if( pxSort->xSkipPass == 0 )
+    {
+        pvSwap = pxSort->pvFrom;
+        pxSort->pvFrom = pxSort->pvTo;
+        pxSort->pvTo = pvSwap;
+    }
+
+    pxSort->uShift += ipsaRADIX_BITS;
+    pxSort->uxNextPart = 0U;
+    pxSort->uxNextKey = 0U;
+
+    if( pxSort->uShift < ( pxSort->uxKeyBytes * 8U ) )
+    {
+        pxSort->ePhase = eIpsaRadixCount;
+        return 1;
+    }
+
+    /* An odd number of real passes leaves the result in the scratch
+     * buffer. */
+    if( pxSort->pvFrom != pxSort->pvKeys )
+    {
+        memcpy( pxSort->pvKeys, pxSort->pvFrom, pxSort->uxCount * pxSort->uxKeyBytes );
+    }
+
+    pxSort->ePhase = eIpsaRadixDone;
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+int xIpsaRadixStep( IpsaRadixSort_t * pxSort,
+                    size_t uxMaxKeys )
+{
+    size_t uxStart, uxEnd, uxStop;
+
+    if( uxMaxKeys == 0U )
+    {
+        uxMaxKeys = 1U;
+    }
+
+    switch( pxSort->ePhase )
+    {
+        case eIpsaRadixCount:
+        case eIpsaRadixScatter:
+            uxStart = prvPartStart( pxSort, pxSort->uxNextPart );
+            uxEnd = prvPartStart( pxSort, pxSort->uxNextPart + 1U );
+            uxStop = ( ( uxEnd - pxSort->uxNextKey ) > uxMaxKeys ) ? ( pxSort->uxNextKey + uxMaxKeys ) : uxEnd;
+
+            if( pxSort->ePhase == eIpsaRadixCount )
+            {
+                if( pxSort->uxNextKey == uxStart )
+                {
+                    memset( pxSort->uxHistogram[ pxSort->uxNextPart ], 0, sizeof( pxSort->uxHistogram[ 0 ] ) );
+                }
+
+                prvCountRange( pxSort, pxSort->uxNextPart, pxSort->uxNextKey, uxStop );
+            }
+            else
+            {
+                prvScatterRange( pxSort, pxSort->uxNextPart, pxSort->uxNextKey, uxStop );
+            }
+
+            pxSort->uxNextKey = uxStop;
+
+            if( uxStop == uxEnd )
+            {
+                pxSort->uxNextPart++;
+
+                if( pxSort->uxNextPart < pxSort->uxParts )
+                {
+                    pxSort->uxNextKey = uxEnd;
+                }
+                else if( pxSort->ePhase == eIpsaRadixCount )
+                {
+                    pxSort->ePhase = eIpsaRadixOffsets;
+                }
+                else
+                {
+                    ( void ) xIpsaRadixNextPass( pxSort );
+                }
+            }
+
+            break;
+
+        case eIpsaRadixOffsets:
+            vIpsaRadixOffsets( pxSort );
+            pxSort->uxNextPart = 0U;
+            pxSort->uxNextKey = 0U;
+            pxSort->ePhase = eIpsaRadixScatter;
+
+            if( pxSort->xSkipPass != 0 )
+            {
+                ( void ) xIpsaRadixNextPass( pxSort );
+            }
+
+            break;
+
+        case eIpsaRadixDone:
+        default:
+            break;
+    }
+
+    return pxSort->ePhase == eIpsaRadixDone;
+}
+/*-----------------------------------------------------------*/
+
+/* Whole sort in the calling task. */
+static void prvRadixSort( void * pvKeys,
+                          void * pvTemp,
+                          size_t uxCount,
+                          size_t uxKeyBytes,
+                          IpsaRadixSort_t * pxWork )
+{
+    vIpsaRadixInit( pxWork, pvKeys, pvTemp, uxCount, uxKeyBytes, 1U );
+
+    while( xIpsaRadixStep( pxWork, uxCount ) == 0 )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaRadixSort32( uint32_t * pulKeys,
+                       uint32_t * pulTemp,
+                       size_t uxCount,
+                       IpsaRadixSort_t * pxWork )
+{
+    prvRadixSort( pulKeys, pulTemp, uxCount, sizeof( uint32_t ), pxWork );
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaRadixSort64( uint64_t * pullKeys,
+                       uint64_t * pullTemp,
+                       size_t uxCount,
+                       IpsaRadixSort_t * pxWork )
+{
+    prvRadixSort( pullKeys, pullTemp, uxCount, sizeof( uint64_t ), pxWork );
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaRadixFlipInt( int * piKeys,
+                        size_t uxCount )
+{
+    uint32_t * pulKeys = ( uint32_t * ) piKeys;
+    size_t x;
+
+    /* Flipping the sign bit maps signed order onto unsigned order. */
+    for( x = 0; x < uxCount; x++ )
+    {
+        pulKeys[ x ] ^= 0x80000000UL;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaRadixSortInt( int * piKeys,
+                        int * piTemp,
+                        size_t uxCount,
+                        IpsaRadixSort_t * pxWork )
+{
+    vIpsaRadixFlipInt( piKeys, uxCount );
+    prvRadixSort( piKeys, piTemp, uxCount, sizeof( uint32_t ), pxWork );
+    vIpsaRadixFlipInt( piKeys, uxCount );
+}
+/*-----------------------------------------------------------*/
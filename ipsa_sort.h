@@ -0,0 +1,130 @@
+/*
+ * LSD radix sort for 32 and 64-bit keys, used to rebuild sorted tables from
+ * unsorted ingest data.
+ *
+ * The one call functions sort in the calling task.  The IpsaRadixSort_t
+ * interface splits the same work into parts so it can be spread over worker
+ * tasks (every part counts, one task computes the offsets, every part
+ * scatters, repeat per digit), as ipsa_sort_bench.c does with threads, or
+ * advanced at most a given number of keys at a time with xIpsaRadixStep(),
+ * so a caller can interleave the sort with its other work.
+ *
+ * IpsaRadixSort_t holds a histogram per part, some ipsaRADIX_MAX_PARTS KB,
+ * so it is always provided by the caller, statically or from the heap,
+ * rather than kept on the stack of the sorting task.
+ *
+ * Keys are sorted as unsigned integers; vIpsaRadixSortInt() handles signed
+ * int tables by flipping the sign bit around the sort, a split sort of int
+ * keys calls vIpsaRadixFlipInt() before and after itself.
+ */
+
+#ifndef IPSA_SORT_H
+#define IPSA_SORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Bits per pass, so four passes for 32-bit keys and eight for 64-bit keys. */
+#define ipsaRADIX_BITS                     ( 8 )
+#define ipsaRADIX_BUCKETS                  ( 1 << ipsaRADIX_BITS )
+
+/* Largest number of parts a sort can be split into. */
+#ifndef ipsaRADIX_MAX_PARTS
+    #define ipsaRADIX_MAX_PARTS            ( 8 )
+#endif
+
+/* Phases of one pass of a split sort. */
+typedef enum
+{
+    eIpsaRadixCount = 0,
+    eIpsaRadixOffsets,
+    eIpsaRadixScatter,
+    eIpsaRadixDone
+} eIpsaRadixPhase;
+
+typedef struct IPSA_RADIX_SORT
+{
+    void * pvKeys;                 /* Keys to sort, the result ends up here. */
+    void * pvTemp;                 /* Scratch buffer of the same size. */
+    size_t uxCount;
+    size_t uxKeyBytes;             /* 4 or 8. */
+    size_t uxParts;
+    void * pvFrom;                 /* Buffer read by the current pass. */
+    void * pvTo;                   /* Buffer written by the current pass. */
+    unsigned uShift;               /* Bit position of the current digit. */
+    eIpsaRadixPhase ePhase;
+    size_t uxNextPart;             /* Used by xIpsaRadixStep(). */
+    size_t uxNextKey;              /* Used by xIpsaRadixStep(), position in the part. */
+    int xSkipPass;                 /* Every key shares the current digit. */
+    size_t uxHistogram[ ipsaRADIX_MAX_PARTS ][ ipsaRADIX_BUCKETS ];
+} IpsaRadixSort_t;
+
+/*
+ * Sort in place, pvTemp/pulTemp must hold uxCount keys.  pxWork is the
+ * sort state, only used for the duration of the call.
+ */
+void vIpsaRadixSort32( uint32_t * pulKeys,
+                       uint32_t * pulTemp,
+                       size_t uxCount,
+                       IpsaRadixSort_t * pxWork );
+void vIpsaRadixSort64( uint64_t * pullKeys,
+                       uint64_t * pullTemp,
+                       size_t uxCount,
+                       IpsaRadixSort_t * pxWork );
+void vIpsaRadixSortInt( int * piKeys,
+                        int * piTemp,
+                        size_t uxCount,
+                        IpsaRadixSort_t * pxWork );
+
+/*
+ * Flips the sign bit of uxCount int keys, mapping signed order onto the
+ * unsigned order of the split sort and back.
+ */
+void vIpsaRadixFlipInt( int * piKeys,
+                        size_t uxCount );
+
+/*
+ * Prepares a sort split into uxParts parts (clamped to
+ * 1..ipsaRADIX_MAX_PARTS).  uxKeyBytes is 4 or 8.
+ */
+void vIpsaRadixInit( IpsaRadixSort_t * pxSort,
+                     void * pvKeys,
+                     void * pvTemp,
+                     size_t uxCount,
+                     size_t uxKeyBytes,
+                     size_t uxParts );
+
+/*
+ * Counting phase for one part.  Parts may run concurrently.
+ */
+void vIpsaRadixCount( IpsaRadixSort_t * pxSort,
+                      size_t uxPart );
+
+/*
+ * Turns the per part histograms into scatter offsets.  Must run alone,
+ * after every part has counted.
+ */
+void vIpsaRadixOffsets( IpsaRadixSort_t * pxSort );
+
+/*
+ * Scatter phase for one part.  Parts may run concurrently, after
+ * vIpsaRadixOffsets().
+ */
+void vIpsaRadixScatter( IpsaRadixSort_t * pxSort,
+                        size_t uxPart );
+
+/*
+ * Moves to the next digit once every part has scattered.  Returns 1 while
+ * passes remain, 0 when the keys are sorted.
+ */
+int xIpsaRadixNextPass( IpsaRadixSort_t * pxSort );
+
+/*
+ * Advances the sort by at most uxMaxKeys keys, counted or scattered, or by
+ * one offsets computation, so the length of a step is bounded whatever the
+ * size of the parts.  Returns 1 once the sort is complete.
+ */
+int xIpsaRadixStep( IpsaRadixSort_t * pxSort,
+                    size_t uxMaxKeys );
+
+#endif /* IPSA_SORT_H */
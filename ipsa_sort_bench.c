@@ -0,0 +1,250 @@
+/*
+ * Host side benchmark of the radix sort of ipsa_sort.c against qsort().
+ *
+ * Build and run on the host (no FreeRTOS needed):
+ *
+ *   gcc -O2 -o ipsa_sort_bench ipsa_sort_bench.c ipsa_sort.c -lpthread
+ *   ./ipsa_sort_bench [max_exponent [threads]]
+ *
+ * Sorts 10^3 up to 10^max_exponent (default 8) random 32 and 64-bit keys
+ * with qsort(), the single task radix sort and the radix sort split over the
+ * given number of threads (default 4), standing in for worker tasks.  Sizes
+ * that cannot be allocated are skipped.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ipsa_sort.h"
+
+/* Shared state of one parallel sort. */
+typedef struct BENCH_PARALLEL
+{
+    IpsaRadixSort_t xSort;
+    pthread_barrier_t xBarrier;
+} BenchParallel_t;
+
+typedef struct BENCH_WORKER
+{
+    BenchParallel_t * pxShared;
+    size_t uxPart;
+} BenchWorker_t;
+
+/*-----------------------------------------------------------*/
+
+static double prvNow( void )
+{
+    struct timespec xTime;
+
+    clock_gettime( CLOCK_MONOTONIC, &xTime );
+
+    return ( double ) xTime.tv_sec + ( ( double ) xTime.tv_nsec * 1e-9 );
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvRandom( uint64_t * pullState )
+{
+    /* xorshift64*, deterministic so every method sorts the same data. */
+    *pullState ^= *pullState >> 12;
+    *pullState ^= *pullState << 25;
+    *pullState ^= *pullState >> 27;
+
+    return *pullState * 2685821657736338717ULL;
+}
+/*-----------------------------------------------------------*/
+
+static int prvCompare32( const void * pvA,
+                         const void * pvB )
+{
+    uint32_t a = *( const uint32_t * ) pvA, b = *( const uint32_t * ) pvB;
+
+    return ( a > b ) - ( a < b );
+}
+
+static int prvCompare64( const void * pvA,
+                         const void * pvB )
+{
+    uint64_t a = *( const uint64_t * ) pvA, b = *( const uint64_t * ) pvB;
+
+    return ( a > b ) - ( a < b );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Worker thread: counts and scatters its part every pass, worker 0 also
+ * computes the offsets and advances the pass between barriers.
+ */
+static void * prvWorker( void * pvArg )
+{
+    BenchWorker_t * pxWorker = ( BenchWorker_t * ) pvArg;
+    BenchParallel_t * pxShared = pxWorker->pxShared;
+    int xMore = 1;
+
+    while( xMore != 0 )
+    {
+        vIpsaRadixCount( &pxShared->xSort, pxWorker->uxPart );
+        pthread_barrier_wait( &pxShared->xBarrier );
+
+        if( pxWorker->uxPart == 0U )
+        {
+            vIpsaRadixOffsets( &pxShared->xSort );
+        }
+
+        pthread_barrier_wait( &pxShared->xBarrier );
+        vIpsaRadixScatter( &pxShared->xSort, pxWorker->uxPart );
+        pthread_barrier_wait( &pxShared->xBarrier );
+
+        if( pxWorker->uxPart == 0U )
+        {
+            ( void ) xIpsaRadixNextPass( &pxShared->xSort );
+        }
+
+        pthread_barrier_wait( &pxShared->xBarrier );
+        xMore = ( pxShared->xSort.ePhase != eIpsaRadixDone );
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+/* Returns the number of parts the sort was split into. */
+static size_t prvParallelSort( void * pvKeys,
+                               void * pvTemp,
+                               size_t uxCount,
+                               size_t uxKeyBytes,
+                               size_t uxThreads )
+{
+    static BenchParallel_t xShared;
+    BenchWorker_t xWorkers[ ipsaRADIX_MAX_PARTS ];
+    pthread_t xThreads[ ipsaRADIX_MAX_PARTS ];
+    size_t x;
+
+    vIpsaRadixInit( &xShared.xSort, pvKeys, pvTemp, uxCount, uxKeyBytes, uxThreads );
+
+    uxThreads = xShared.xSort.uxParts;
+
+    if( xShared.xSort.ePhase == eIpsaRadixDone )
+    {
+        return uxThreads;
+    }
+
+    pthread_barrier_init( &xShared.xBarrier, NULL, ( unsigned ) uxThreads );
+
+    for( x = 0; x < uxThreads; x++ )
+    {
+        xWorkers[ x ].pxShared = &xShared;
+        xWorkers[ x ].uxPart = x;
+        pthread_create( &xThreads[ x ], NULL, prvWorker, &xWorkers[ x ] );
+    }
+
+    for( x = 0; x < uxThreads; x++ )
+    {
+        pthread_join( xThreads[ x ], NULL );
+    }
+
+    pthread_barrier_destroy( &xShared.xBarrier );
+
+    return uxThreads;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmark( size_t uxCount,
+                          size_t uxKeyBytes,
+                          size_t uxThreads )
+{
+    size_t uxBytes = uxCount * uxKeyBytes;
+    unsigned char * pucInput = malloc( uxBytes );
+    unsigned char * pucReference = malloc( uxBytes );
+    unsigned char * pucKeys = malloc( uxBytes );
+    unsigned char * pucTemp = malloc( uxBytes );
+    uint64_t ullState = 0x9E3779B97F4A7C15ULL;
+    static IpsaRadixSort_t xWork;
+    double dStart, dQsort, dRadix, dParallel;
+    size_t x, uxParts;
+
+    if( ( pucInput == NULL ) || ( pucReference == NULL ) || ( pucKeys == NULL ) || ( pucTemp == NULL ) )
+    {
+        printf( "%10zu  %2zu-bit  skipped, out of memory\n", uxCount, uxKeyBytes * 8U );
+        free( pucInput );
+        free( pucReference );
+        free( pucKeys );
+        free( pucTemp );
+        return;
+    }
+
+    for( x = 0; x < uxCount; x++ )
+    {
+        uint64_t ullKey = prvRandom( &ullState );
+
+        memcpy( &pucInput[ x * uxKeyBytes ], &ullKey, uxKeyBytes );
+    }
+
+    memcpy( pucReference, pucInput, uxBytes );
+    dStart = prvNow();
+    qsort( pucReference, uxCount, uxKeyBytes, ( uxKeyBytes == 4U ) ? prvCompare32 : prvCompare64 );
+    dQsort = prvNow() - dStart;
+
+    memcpy( pucKeys, pucInput, uxBytes );
+    dStart = prvNow();
+
+    if( uxKeyBytes == 4U )
+    {
+        vIpsaRadixSort32( ( uint32_t * ) pucKeys, ( uint32_t * ) pucTemp, uxCount, &xWork );
+    }
+    else
+    {
+        vIpsaRadixSort64( ( uint64_t * ) pucKeys, ( uint64_t * ) pucTemp, uxCount, &xWork );
+    }
+
+    dRadix = prvNow() - dStart;
+
+    if( memcmp( pucKeys, pucReference, uxBytes ) != 0 )
+    {
+        printf( "radix sort result differs from qsort\n" );
+        exit( 1 );
+    }
+
+    memcpy( pucKeys, pucInput, uxBytes );
+    dStart = prvNow();
+    uxParts = prvParallelSort( pucKeys, pucTemp, uxCount, uxKeyBytes, uxThreads );
+    dParallel = prvNow() - dStart;
+
+    if( memcmp( pucKeys, pucReference, uxBytes ) != 0 )
+    {
+        printf( "parallel radix sort result differs from qsort\n" );
+        exit( 1 );
+    }
+
+    printf( "%10zu  %2zu-bit  qsort %10.3f ms  radix %10.3f ms (x%5.1f)  radix/%zu %10.3f ms (x%5.1f)\n",
+            uxCount, uxKeyBytes * 8U,
+            dQsort * 1e3, dRadix * 1e3, dQsort / dRadix,
+            uxParts, dParallel * 1e3, dQsort / dParallel );
+
+    free( pucInput );
+    free( pucReference );
+    free( pucKeys );
+    free( pucTemp );
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    int xMaxExponent = ( argc > 1 ) ? atoi( argv[ 1 ] ) : 8;
+    size_t uxThreads = ( argc > 2 ) ? ( size_t ) atoi( argv[ 2 ] ) : 4U;
+    size_t uxCount = 1000U;
+    int xExponent;
+
+    for( xExponent = 3; xExponent <= xMaxExponent; xExponent++ )
+    {
+        prvBenchmark( uxCount, sizeof( uint32_t ), uxThreads );
+        prvBenchmark( uxCount, sizeof( uint64_t ), uxThreads );
+        uxCount *= 10U;
+    }
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,129 @@
+/*
+ * Fahrenheit to Celsius conversion for 12-bit integer sensor codes, see
+ * ipsa_temp.h.
+ */
+
+#include "ipsa_temp.h"
+
+#if ( ipsaDISPATCH_X86 == 1 )
+    #include <immintrin.h>
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* The same formula Task2 used to evaluate at run time. */
+#define tempCONVERT( code )    ( ( float ) ( ( 5.0 / 9.0 ) * ( ipsaTEMP_CODE_TO_F( code ) - 32.0 ) ) )
+
+/* Expand to 4096 consecutive table entries starting at code n. */
+#define tempE1( n )            tempCONVERT( n )
+#define tempE4( n )            tempE1( n ), tempE1( ( n ) + 1 ), tempE1( ( n ) + 2 ), tempE1( ( n ) + 3 )
+#define tempE16( n )           tempE4( n ), tempE4( ( n ) + 4 ), tempE4( ( n ) + 8 ), tempE4( ( n ) + 12 )
+#define tempE64( n )           tempE16( n ), tempE16( ( n ) + 16 ), tempE16( ( n ) + 32 ), tempE16( ( n ) + 48 )
+#define tempE256( n )          tempE64( n ), tempE64( ( n ) + 64 ), tempE64( ( n ) + 128 ), tempE64( ( n ) + 192 )
+#define tempE1024( n )         tempE256( n ), tempE256( ( n ) + 256 ), tempE256( ( n ) + 512 ), tempE256( ( n ) + 768 )
+#define tempE4096( n )         tempE1024( n ), tempE1024( ( n ) + 1024 ), tempE1024( ( n ) + 2048 ), tempE1024( ( n ) + 3072 )
+
+#if ( ipsaTEMP_CODE_BITS != 12 )
+    #error The table expansion below assumes 12-bit codes.
+#endif
+
+static const float fCelsiusTable[ ipsaTEMP_CODE_COUNT ] =
+{
+    tempE4096( 0 )
+};
+
+/*-----------------------------------------------------------*/
+
+float fIpsaTempCelsius( uint16_t usCode )
+{
+    return fCelsiusTable[ usCode & ipsaTEMP_CODE_MASK ];
+}
+/*-----------------------------------------------------------*/
+
+float fIpsaTempCelsiusInterpolated( float fCode )
+{
+    uint32_t ulIndex;
+    float fFraction;
+
+    if( !( fCode > 0.0f ) )
+    {
+        return fCelsiusTable[ 0 ];
+    }
+
+    if( fCode >= ( float ) ( ipsaTEMP_CODE_COUNT - 1 ) )
+    {
+        return fCelsiusTable[ ipsaTEMP_CODE_COUNT - 1 ];
+    }
+
+    ulIndex = ( uint32_t ) fCode;
+    fFraction = fCode - ( float ) ulIndex;
+
+    return fCelsiusTable[ ulIndex ] + ( fFraction * ( fCelsiusTable[ ulIndex + 1U ] - fCelsiusTable[ ulIndex ] ) );
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaTempCelsiusBatch( const uint16_t * pusCodes,
+                            float * pfCelsius,
+                            size_t uxCount )
+{
+    pxIpsaTempBatchKernel( pusCodes, pfCelsius, uxCount );
+}
+/*-----------------------------------------------------------*/
+
+void vIpsaTempCelsiusBatchScalar( const uint16_t * pusCodes,
+                                  float * pfCelsius,
+                                  size_t uxCount )
+{
+    size_t x;
+
+    for( x = 0; x < uxCount; x++ )
+    {
+        pfCelsius[ x ] = fCelsiusTable[ pusCodes[ x ] & ipsaTEMP_CODE_MASK ];
+    }
+}
+/*-----------------------------------------------------------*/
+
+#if ( ipsaDISPATCH_X86 == 1 )
+
+    __attribute__( ( target( "avx2" ) ) )
+    void vIpsaTempCelsiusBatchAvx2( const uint16_t * pusCodes,
+                                    float * pfCelsius,
+                                    size_t uxCount )
+    {
+        const __m256i xMask = _mm256_set1_epi32( ipsaTEMP_CODE_MASK );
+        size_t x = 0;
+
+        /* Widen eight codes to 32-bit indices and gather their entries. */
+        for( ; ( x + 8U ) <= uxCount; x += 8U )
+        {
+            __m128i xCodes = _mm_loadu_si128( ( const __m128i * ) &pusCodes[ x ] );
+            __m256i xIndices = _mm256_and_si256( _mm256_cvtepu16_epi32( xCodes ), xMask );
+
+            _mm256_storeu_ps( &pfCelsius[ x ], _mm256_i32gather_ps( fCelsiusTable, xIndices, 4 ) );
+        }
+
+        vIpsaTempCelsiusBatchScalar( &pusCodes[ x ], &pfCelsius[ x ], uxCount - x );
+    }
+/*-----------------------------------------------------------*/
+
+    __attribute__( ( target( "avx512f" ) ) )
+    void vIpsaTempCelsiusBatchAvx512( const uint16_t * pusCodes,
+                                      float * pfCelsius,
+                                      size_t uxCount )
+    {
+        const __m512i xMask = _mm512_set1_epi32( ipsaTEMP_CODE_MASK );
+        size_t x = 0;
+
+        for( ; ( x + 16U ) <= uxCount; x += 16U )
+        {
+            __m256i xCodes = _mm256_loadu_si256( ( const __m256i * ) &pusCodes[ x ] );
+            __m512i xIndices = _mm512_and_si512( _mm512_cvtepu16_epi32( xCodes ), xMask );
+
+            _mm512_storeu_ps( &pfCelsius[ x ], _mm512_i32gather_ps( xIndices, fCelsiusTable, 4 ) );
+        }
+
+        vIpsaTempCelsiusBatchScalar( &pusCodes[ x ], &pfCelsius[ x ], uxCount - x );
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* ipsaDISPATCH_X86 */
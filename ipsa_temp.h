@@ -0,0 +1,62 @@
+/*
+ * Fahrenheit to Celsius conversion for 12-bit integer sensor codes.
+ *
+ * The conversion table is a constant expression expanded by the
+ * preprocessor, so the compiler computes all 4096 entries at build time and
+ * a conversion is a single load.
+ */
+
+#ifndef IPSA_TEMP_H
+#define IPSA_TEMP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ipsa_dispatch.h"
+
+/* Number of bits delivered by the sensor. */
+#define ipsaTEMP_CODE_BITS                 ( 12 )
+#define ipsaTEMP_CODE_COUNT                ( 1 << ipsaTEMP_CODE_BITS )
+#define ipsaTEMP_CODE_MASK                 ( ipsaTEMP_CODE_COUNT - 1 )
+
+/* Fahrenheit value represented by a sensor code.  Codes are whole degrees
+ * by default; override to match another sensor scale. */
+#ifndef ipsaTEMP_CODE_TO_F
+    #define ipsaTEMP_CODE_TO_F( code )     ( ( double ) ( code ) )
+#endif
+
+/*
+ * Celsius value of a sensor code, only the low ipsaTEMP_CODE_BITS are used.
+ */
+float fIpsaTempCelsius( uint16_t usCode );
+
+/*
+ * Celsius value of a fractional code, linearly interpolated between the two
+ * neighbouring table entries and clamped to the table range.
+ */
+float fIpsaTempCelsiusInterpolated( float fCode );
+
+/*
+ * Converts uxCount codes at once through the kernel bound by
+ * ipsa_dispatch.c: AVX2 or AVX-512 gathers where available, plain table
+ * loads otherwise.
+ */
+void vIpsaTempCelsiusBatch( const uint16_t * pusCodes,
+                            float * pfCelsius,
+                            size_t uxCount );
+
+/* Kernel variants, selected by ipsa_dispatch.c. */
+void vIpsaTempCelsiusBatchScalar( const uint16_t * pusCodes,
+                                  float * pfCelsius,
+                                  size_t uxCount );
+
+#if ( ipsaDISPATCH_X86 == 1 )
+    void vIpsaTempCelsiusBatchAvx2( const uint16_t * pusCodes,
+                                    float * pfCelsius,
+                                    size_t uxCount );
+    void vIpsaTempCelsiusBatchAvx512( const uint16_t * pusCodes,
+                                      float * pfCelsius,
+                                      size_t uxCount );
+#endif
+
+#endif /* IPSA_TEMP_H */
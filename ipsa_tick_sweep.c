@@ -0,0 +1,244 @@
+/*
+ * Host side tool that picks configTICK_RATE_HZ from measurements rather than
+ * habit.
+ *
+ * Build and run on the host (no FreeRTOS needed):
+ *
+ *   gcc -O2 -o ipsa_tick_sweep ipsa_tick_sweep.c
+ *   ./ipsa_tick_sweep 'build-and-run command' [rate ...]
+ *
+ * The command is run through the shell once per rate, with every %u in it
+ * replaced by the rate, and must build the demo with ipsaUSE_TICK_BENCH and
+ * ipsaUSE_OVERHEAD_ACCOUNTING set to 1 for that rate and run it, e.g.
+ *
+ *   ./ipsa_tick_sweep 'make -s clean all CFLAGS+=-DconfigTICK_RATE_HZ=%u && ./build/posix_demo'
+ *
+ * FreeRTOSConfig.h must then only define configTICK_RATE_HZ when it is not
+ * already defined.  Without rates, 100 Hz to 10 kHz are swept.  The tool
+ * prints the kernel overhead, the release jitter and the deadline misses of
+ * each rate, and recommends the lowest rate with no miss whose p99 release
+ * jitter stays within JITTER_BUDGET_PERCENT of the shortest task period, as
+ * reported by the demo on its IPSA_TICK_BENCH line.
+ * Failing that, the rate with the fewest misses, then the least jitter.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_RATES                    ( 16 )
+#define MAX_COMMAND                  ( 1024 )
+
+#define JITTER_BUDGET_PERCENT        ( 1UL )
+
+typedef struct TICK_RESULT
+{
+    unsigned long ulRate;
+    int iValid;
+    unsigned long ulOverheadPpm;
+    unsigned long long ullP99Ns;
+    unsigned long long ullMaxNs;
+    unsigned long ulMisses;
+    unsigned long ulJobs;
+    unsigned long long ullPeriodNs;       /* Shortest task period at this rate. */
+} TickResult_t;
+
+static const unsigned long ulDefaultRates[] = { 100UL, 250UL, 500UL, 1000UL, 2000UL, 5000UL, 10000UL };
+
+/*-----------------------------------------------------------*/
+
+/* Copies pcTemplate to pcCommand with every %u replaced by ulRate. */
+static int prvExpand( const char * pcTemplate,
+                      unsigned long ulRate,
+                      char * pcCommand,
+                      size_t uxSize )
+{
+    size_t uxUsed = 0;
+    int iWritten;
+
+    while( *pcTemplate != '\0' )
+    {
+        if( ( pcTemplate[ 0 ] == '%' ) && ( pcTemplate[ 1 ] == 'u' ) )
+        {
+            iWritten = snprintf( &pcCommand[ uxUsed ], uxSize - uxUsed, "%lu", ulRate );
+            pcTemplate += 2;
+        }
+        else
+        {
+            iWritten = snprintf( &pcCommand[ uxUsed ], uxSize - uxUsed, "%c", *pcTemplate );
+            pcTemplate++;
+        }
+
+        if( ( iWritten < 0 ) || ( ( size_t ) iWritten >= uxSize - uxUsed ) )
+        {
+            return 0;
+        }
+
+        uxUsed += ( size_t ) iWritten;
+    }
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+/* Runs the benchmark at pxResult->ulRate and parses its IPSA_TICK_BENCH line. */
+static void prvRun( const char * pcTemplate,
+                    TickResult_t * pxResult )
+{
+    char cCommand[ MAX_COMMAND ];
+    char cLine[ 512 ];
+    unsigned long ulRate;
+    FILE * pxOutput;
+
+    pxResult->iValid = 0;
+
+    if( prvExpand( pcTemplate, pxResult->ulRate, cCommand, sizeof( cCommand ) ) == 0 )
+    {
+        fprintf( stderr, "Command too long\n" );
+        return;
+    }
+
+    fprintf( stderr, "%lu Hz: %s\n", pxResult->ulRate, cCommand );
+    pxOutput = popen( cCommand, "r" );
+
+    if( pxOutput == NULL )
+    {
+        return;
+    }
+
+    /* The demo prints its usual output too, only the last line counts. */
+    while( fgets( cLine, sizeof( cLine ), pxOutput ) != NULL )
+    {
+        if( sscanf( cLine, "IPSA_TICK_BENCH rate=%lu overhead_ppm=%lu jitter_p99_ns=%llu jitter_max_ns=%llu misses=%lu jobs=%lu period_ns=%llu",
+                    &ulRate, &pxResult->ulOverheadPpm, &pxResult->ullP99Ns, &pxResult->ullMaxNs,
+                    &pxResult->ulMisses, &pxResult->ulJobs, &pxResult->ullPeriodNs ) == 7 )
+        {
+            /* A build that ignored the rate would compare nothing. */
+            pxResult->iValid = ( ulRate == pxResult->ulRate );
+
+            if( pxResult->iValid == 0 )
+            {
+                fprintf( stderr, "Asked for %lu Hz, the demo ran at %lu Hz\n", pxResult->ulRate, ulRate );
+            }
+        }
+    }
+
+    pclose( pxOutput );
+}
+/*-----------------------------------------------------------*/
+
+/* Nonzero if the rate missed no deadline and kept within the jitter budget. */
+static int prvFits( const TickResult_t * pxResult )
+{
+    return ( pxResult->ulMisses == 0UL ) &&
+           ( pxResult->ullP99Ns <= pxResult->ullPeriodNs * JITTER_BUDGET_PERCENT / 100ULL );
+}
+/*-----------------------------------------------------------*/
+
+/* Nonzero if pxA is a better choice than pxB. */
+static int prvBetter( const TickResult_t * pxA,
+                      const TickResult_t * pxB )
+{
+    int iAFits = prvFits( pxA );
+    int iBFits = prvFits( pxB );
+
+    if( iAFits != iBFits )
+    {
+        return iAFits;
+    }
+
+    /* Among the rates that fit, the lowest costs the least overhead. */
+    if( iAFits != 0 )
+    {
+        return pxA->ulRate < pxB->ulRate;
+    }
+
+    if( pxA->ulMisses != pxB->ulMisses )
+    {
+        return pxA->ulMisses < pxB->ulMisses;
+    }
+
+    return pxA->ullP99Ns < pxB->ullP99Ns;
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    TickResult_t xResults[ MAX_RATES ];
+    const TickResult_t * pxBest = NULL;
+    size_t uxCount, x;
+
+    if( argc < 2 )
+    {
+        fprintf( stderr, "Usage: %s 'build-and-run command with %%u for the rate' [rate ...]\n", argv[ 0 ] );
+        return 1;
+    }
+
+    if( argc > 2 )
+    {
+        uxCount = ( size_t ) ( argc - 2 );
+
+        if( uxCount > MAX_RATES )
+        {
+            fprintf( stderr, "At most %d rates are supported\n", MAX_RATES );
+            return 1;
+        }
+
+        for( x = 0; x < uxCount; x++ )
+        {
+            xResults[ x ].ulRate = strtoul( argv[ x + 2U ], NULL, 10 );
+
+            if( xResults[ x ].ulRate == 0UL )
+            {
+                fprintf( stderr, "Bad rate '%s'\n", argv[ x + 2U ] );
+                return 1;
+            }
+        }
+    }
+    else
+    {
+        uxCount = sizeof( ulDefaultRates ) / sizeof( ulDefaultRates[ 0 ] );
+
+        for( x = 0; x < uxCount; x++ )
+        {
+            xResults[ x ].ulRate = ulDefaultRates[ x ];
+        }
+    }
+
+    for( x = 0; x < uxCount; x++ )
+    {
+        prvRun( argv[ 1 ], &xResults[ x ] );
+    }
+
+    printf( "%8s %10s %14s %14s %8s %8s\n", "rate Hz", "overhead", "p99 jitter us", "max jitter us", "misses", "jobs" );
+
+    for( x = 0; x < uxCount; x++ )
+    {
+        if( xResults[ x ].iValid == 0 )
+        {
+            printf( "%8lu %10s\n", xResults[ x ].ulRate, "no result" );
+            continue;
+        }
+
+        printf( "%8lu %9.3f%% %14.1f %14.1f %8lu %8lu\n", xResults[ x ].ulRate,
+                ( double ) xResults[ x ].ulOverheadPpm / 10000.0,
+                ( double ) xResults[ x ].ullP99Ns / 1000.0, ( double ) xResults[ x ].ullMaxNs / 1000.0,
+                xResults[ x ].ulMisses, xResults[ x ].ulJobs );
+
+        if( ( pxBest == NULL ) || prvBetter( &xResults[ x ], pxBest ) )
+        {
+            pxBest = &xResults[ x ];
+        }
+    }
+
+    if( pxBest == NULL )
+    {
+        printf( "No rate produced a result.\n" );
+        return 2;
+    }
+
+    printf( "Recommended: #define configTICK_RATE_HZ ( %luU )%s\n", pxBest->ulRate,
+            ( prvFits( pxBest ) != 0 ) ? "" : ", no rate met the jitter budget without misses" );
+
+    return 0;
+}
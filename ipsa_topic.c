@@ -0,0 +1,285 @@
+/*
+ * Publish/subscribe topics, see ipsa_topic.h.
+ */
+
+#include <string.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Local includes. */
+#include "ipsa_topic.h"
+
+/* Bytes in front of each message holding its sequence number, a multiple of
+ * the strictest alignment a message may need. */
+#define topicHEADER_SIZE                   ( sizeof( uint64_t ) )
+
+#define topicSTAMP( pxTopic, ulSequence ) \
+    ( ( volatile uint32_t * ) &( pxTopic )->pucRing[ ( ( ulSequence ) & ( pxTopic )->ulMask ) * ( pxTopic )->uxSlotSize ] )
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaTopicCreate( IpsaTopic_t * pxTopic,
+                             size_t uxMessageSize,
+                             UBaseType_t uxDepth )
+{
+    UBaseType_t x;
+
+    configASSERT( ( uxDepth > 0U ) && ( ( uxDepth & ( uxDepth - 1U ) ) == 0U ) );
+
+    pxTopic->uxMessageSize = uxMessageSize;
+    pxTopic->uxSlotSize = topicHEADER_SIZE + ( ( uxMessageSize + topicHEADER_SIZE - 1U ) & ~( topicHEADER_SIZE - 1U ) );
+    pxTopic->ulMask = ( uint32_t ) uxDepth - 1U;
+    pxTopic->ulHead = 0;
+    pxTopic->uxSubscribers = 0;
+    pxTopic->ulPublished = 0;
+    pxTopic->ulPublishTimeouts = 0;
+    pxTopic->pucRing = ( uint8_t * ) pvPortMalloc( uxDepth * pxTopic->uxSlotSize );
+    pxTopic->xSpace = xSemaphoreCreateBinary();
+
+    if( ( pxTopic->pucRing == NULL ) || ( pxTopic->xSpace == NULL ) )
+    {
+        return pdFAIL;
+    }
+
+    /* A slot is readable at sequence s when its stamp is s.  Stamp each
+     * empty slot with a sequence number it will never be read at. */
+    for( x = 0; x < uxDepth; x++ )
+    {
+        *topicSTAMP( pxTopic, x ) = ( uint32_t ) x + 1U;
+    }
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaTopicSubscribe( IpsaTopic_t * pxTopic,
+                                eIpsaTopicPolicy ePolicy )
+{
+    IpsaTopicSubscriber_t * pxSubscriber;
+    SemaphoreHandle_t xReady = xSemaphoreCreateBinary();
+    BaseType_t xId = -1;
+
+    if( xReady == NULL )
+    {
+        return -1;
+    }
+
+    taskENTER_CRITICAL();
+    {
+        if( pxTopic->uxSubscribers < ipsaTOPIC_MAX_SUBSCRIBERS )
+        {
+            xId = ( BaseType_t ) pxTopic->uxSubscribers;
+            pxSubscriber = &pxTopic->xSubscribers[ xId ];
+            pxSubscriber->ulCursor = pxTopic->ulHead;
+            pxSubscriber->ePolicy = ePolicy;
+            pxSubscriber->xReady = xReady;
+            pxSubscriber->ulDropped = 0;
+
+            /* Publishers only look at subscribers below uxSubscribers. */
+            portMEMORY_BARRIER();
+            pxTopic->uxSubscribers++;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( xId < 0 )
+    {
+        vSemaphoreDelete( xReady );
+    }
+
+    return xId;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaTopicPublish( IpsaTopic_t * pxTopic,
+                              const void * pvMessage,
+                              TickType_t xTicksToWait )
+{
+    volatile uint32_t * pulStamp;
+    TimeOut_t xTimeOut;
+    UBaseType_t x;
+    uint32_t ulSequence = 0;
+    BaseType_t xFull;
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    for( ;; )
+    {
+        taskENTER_CRITICAL();
+        {
+            xFull = pdFALSE;
+
+            for( x = 0; x < pxTopic->uxSubscribers; x++ )
+            {
+                if( ( pxTopic->xSubscribers[ x ].ePolicy == eIpsaTopicBlockPublisher ) &&
+                    ( ( uint32_t ) ( pxTopic->ulHead - pxTopic->xSubscribers[ x ].ulCursor ) > pxTopic->ulMask ) )
+                {
+                    xFull = pdTRUE;
+                }
+            }
+
+            if( xFull == pdFALSE )
+            {
+                /* Reserve the slot and mark it as being written: its stamp
+                 * matches neither the old message nor the new one. */
+                ulSequence = pxTopic->ulHead;
+                *topicSTAMP( pxTopic, ulSequence ) = ulSequence + 1U;
+                pxTopic->ulHead = ulSequence + 1U;
+                pxTopic->ulPublished++;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( xFull == pdFALSE )
+        {
+            break;
+        }
+
+        if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+        {
+            pxTopic->ulPublishTimeouts++;
+            return pdFAIL;
+        }
+
+        ( void ) xSemaphoreTake( pxTopic->xSpace, xTicksToWait );
+    }
+
+    pulStamp = topicSTAMP( pxTopic, ulSequence );
+    memcpy( ( uint8_t * ) pulStamp + topicHEADER_SIZE, pvMessage, pxTopic->uxMessageSize );
+    portMEMORY_BARRIER();
+    *pulStamp = ulSequence;
+
+    for( x = 0; x < pxTopic->uxSubscribers; x++ )
+    {
+        ( void ) xSemaphoreGive( pxTopic->xSubscribers[ x ].xReady );
+    }
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+const void * pvIpsaTopicPeek( IpsaTopic_t * pxTopic,
+                              BaseType_t xSubscriber )
+{
+    IpsaTopicSubscriber_t * pxSubscriber = &pxTopic->xSubscribers[ xSubscriber ];
+    const void * pvMessage = NULL;
+    uint32_t ulLag, ulKeep;
+
+    taskENTER_CRITICAL();
+    {
+        ulLag = pxTopic->ulHead - pxSubscriber->ulCursor;
+
+        /* Apply the policy of a lossy subscriber that fell behind. */
+        ulKeep = ( pxSubscriber->ePolicy == eIpsaTopicLatestOnly ) ? 1U :
+                 ( pxSubscriber->ePolicy == eIpsaTopicDropOldest ) ? ( pxTopic->ulMask + 1U ) : ulLag;
+
+        if( ulLag > ulKeep )
+        {
+            pxSubscriber->ulDropped += ulLag - ulKeep;
+            pxSubscriber->ulCursor = pxTopic->ulHead - ulKeep;
+            ulLag = ulKeep;
+        }
+
+        if( ( ulLag != 0U ) && ( *topicSTAMP( pxTopic, pxSubscriber->ulCursor ) == pxSubscriber->ulCursor ) )
+        {
+            pvMessage = ( const uint8_t * ) topicSTAMP( pxTopic, pxSubscriber->ulCursor ) + topicHEADER_SIZE;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return pvMessage;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaTopicRelease( IpsaTopic_t * pxTopic,
+                              BaseType_t xSubscriber )
+{
+    IpsaTopicSubscriber_t * pxSubscriber = &pxTopic->xSubscribers[ xSubscriber ];
+    BaseType_t xIntact;
+
+    taskENTER_CRITICAL();
+    {
+        /* A publisher that lapped a lossy reader restamped the slot. */
+        xIntact = ( *topicSTAMP( pxTopic, pxSubscriber->ulCursor ) == pxSubscriber->ulCursor ) ? pdPASS : pdFAIL;
+
+        if( xIntact == pdFAIL )
+        {
+            pxSubscriber->ulDropped++;
+        }
+
+        pxSubscriber->ulCursor++;
+    }
+    taskEXIT_CRITICAL();
+
+    if( pxSubscriber->ePolicy == eIpsaTopicBlockPublisher )
+    {
+        ( void ) xSemaphoreGive( pxTopic->xSpace );
+    }
+
+    return xIntact;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaTopicWait( IpsaTopic_t * pxTopic,
+                           BaseType_t xSubscriber,
+                           TickType_t xTicksToWait )
+{
+    TimeOut_t xTimeOut;
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    /* The semaphore may still hold a give for a message already read, so
+     * wake ups are only hints. */
+    while( pvIpsaTopicPeek( pxTopic, xSubscriber ) == NULL )
+    {
+        if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+        {
+            return pdFALSE;
+        }
+
+        ( void ) xSemaphoreTake( pxTopic->xSubscribers[ xSubscriber ].xReady, xTicksToWait );
+    }
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIpsaTopicReceive( IpsaTopic_t * pxTopic,
+                              BaseType_t xSubscriber,
+                              void * pvBuffer,
+                              TickType_t xTicksToWait )
+{
+    const void * pvMessage;
+    TimeOut_t xTimeOut;
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    for( ;; )
+    {
+        if( xIpsaTopicWait( pxTopic, xSubscriber, xTicksToWait ) == pdFALSE )
+        {
+            return pdFAIL;
+        }
+
+        pvMessage = pvIpsaTopicPeek( pxTopic, xSubscriber );
+
+        if( pvMessage != NULL )
+        {
+            memcpy( pvBuffer, pvMessage, pxTopic->uxMessageSize );
+
+            if( xIpsaTopicRelease( pxTopic, xSubscriber ) == pdPASS )
+            {
+                return pdPASS;
+            }
+        }
+
+        if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+        {
+            return pdFAIL;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,121 @@
+/*
+ * Publish/subscribe topics with zero-copy fan-out.
+ *
+ * A topic is a ring of uxDepth fixed size messages.  Publishers copy each
+ * message into the ring once; every subscriber has its own read cursor and
+ * reads the message in place with pvIpsaTopicPeek() / xIpsaTopicRelease(),
+ * so adding a subscriber adds neither a queue nor a copy.
+ *
+ * Each subscriber chooses what happens when it falls uxDepth messages
+ * behind:
+ *   eIpsaTopicDropOldest  - its cursor skips the overwritten messages, which
+ *                           are counted in ulDropped.  Publishers never wait.
+ *   eIpsaTopicLatestOnly  - it only ever sees the newest message, for state
+ *                           such as the last sensor reading.
+ *   eIpsaTopicBlockPublisher - publishers wait for it (or fail after their
+ *                           timeout), nothing is lost.
+ *
+ * Publishers are serialised by a short critical section around the
+ * reservation of a sequence number; the copy itself runs with interrupts
+ * enabled.  Each slot carries the sequence number of its message, which
+ * lets a lossy reader detect that a slot was overwritten while it read it.
+ */
+
+#ifndef IPSA_TOPIC_H
+#define IPSA_TOPIC_H
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+#ifndef ipsaTOPIC_MAX_SUBSCRIBERS
+    #define ipsaTOPIC_MAX_SUBSCRIBERS      ( 4 )
+#endif
+
+typedef enum
+{
+    eIpsaTopicDropOldest = 0,
+    eIpsaTopicLatestOnly,
+    eIpsaTopicBlockPublisher
+} eIpsaTopicPolicy;
+
+typedef struct IPSA_TOPIC_SUBSCRIBER
+{
+    volatile uint32_t ulCursor;     /* Sequence number of the next message to read. */
+    eIpsaTopicPolicy ePolicy;
+    SemaphoreHandle_t xReady;       /* Given by every publication. */
+    uint32_t ulDropped;             /* Messages skipped by the policy or overwritten while read. */
+} IpsaTopicSubscriber_t;
+
+typedef struct IPSA_TOPIC
+{
+    uint8_t * pucRing;              /* uxDepth slots of uxSlotSize bytes. */
+    size_t uxMessageSize;
+    size_t uxSlotSize;              /* Stamp plus message, rounded for alignment. */
+    uint32_t ulMask;                /* uxDepth - 1, uxDepth is a power of two. */
+    volatile uint32_t ulHead;       /* Sequence number of the next publication. */
+    IpsaTopicSubscriber_t xSubscribers[ ipsaTOPIC_MAX_SUBSCRIBERS ];
+    UBaseType_t uxSubscribers;
+    SemaphoreHandle_t xSpace;       /* Given when a blocking subscriber frees a slot. */
+    uint32_t ulPublished;
+    uint32_t ulPublishTimeouts;
+} IpsaTopic_t;
+
+/*
+ * Allocates a ring of uxDepth messages of uxMessageSize bytes.  uxDepth must
+ * be a power of two.  Returns pdFAIL if the allocation failed.
+ */
+BaseType_t xIpsaTopicCreate( IpsaTopic_t * pxTopic,
+                             size_t uxMessageSize,
+                             UBaseType_t uxDepth );
+
+/*
+ * Adds a subscriber that sees the messages published from now on.  Returns
+ * its id, or -1 if ipsaTOPIC_MAX_SUBSCRIBERS are already subscribed or its
+ * semaphore could not be created.
+ */
+BaseType_t xIpsaTopicSubscribe( IpsaTopic_t * pxTopic,
+                                eIpsaTopicPolicy ePolicy );
+
+/*
+ * Copies pvMessage into the ring and wakes the subscribers.  Waits at most
+ * xTicksToWait for eIpsaTopicBlockPublisher subscribers that are uxDepth
+ * messages behind, returns pdFAIL if they still are.
+ */
+BaseType_t xIpsaTopicPublish( IpsaTopic_t * pxTopic,
+                              const void * pvMessage,
+                              TickType_t xTicksToWait );
+
+/*
+ * Next unread message of subscriber xSubscriber, in place, or NULL if there
+ * is none.  The pointer stays usable until xIpsaTopicRelease().  Never
+ * blocks.
+ */
+const void * pvIpsaTopicPeek( IpsaTopic_t * pxTopic,
+                              BaseType_t xSubscriber );
+
+/*
+ * Moves past the message returned by pvIpsaTopicPeek().  Returns pdFAIL if
+ * a lossy subscriber's message was overwritten while it was being read, in
+ * which case what was read must be discarded.
+ */
+BaseType_t xIpsaTopicRelease( IpsaTopic_t * pxTopic,
+                              BaseType_t xSubscriber );
+
+/*
+ * Blocks at most xTicksToWait until subscriber xSubscriber has an unread
+ * message.  Returns pdTRUE if it has.
+ */
+BaseType_t xIpsaTopicWait( IpsaTopic_t * pxTopic,
+                           BaseType_t xSubscriber,
+                           TickType_t xTicksToWait );
+
+/*
+ * Copying receive for callers that keep the message: waits like
+ * xIpsaTopicWait() and copies the next intact message into pvBuffer.
+ */
+BaseType_t xIpsaTopicReceive( IpsaTopic_t * pxTopic,
+                              BaseType_t xSubscriber,
+                              void * pvBuffer,
+                              TickType_t xTicksToWait );
+
+#endif /* IPSA_TOPIC_H */